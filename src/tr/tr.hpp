@@ -1,3 +1,4 @@
 #pragma once
 
+#include "trOcclusionCuller.hpp"
 #include "trRasterizer.hpp"
\ No newline at end of file
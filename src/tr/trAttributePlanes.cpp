@@ -0,0 +1,28 @@
+#include "trAttributePlanes.hpp"
+
+tr::AttributePlanes::AttributePlanes(const std::array<TransformedVertex, 3>& vertices) :
+	origin(vertices[0])
+{
+	const Vector4& position0 = vertices[0].projectedPosition;
+	const Vector4& position1 = vertices[1].projectedPosition;
+	const Vector4& position2 = vertices[2].projectedPosition;
+
+	const float    area      = (position1.x - position0.x) * (position2.y - position0.y) - (position1.y - position0.y) * (position2.x - position0.x);
+
+	// Degenerate triangles are never rasterized, so their planes are left flat
+	if (area == 0.0f)
+	{
+		return;
+	}
+
+	// Gradients of the barycentric weights, each one is the edge function opposite its vertex over the area
+	const float    weight0X  = (position1.y - position2.y) / area;
+	const float    weight1X  = (position2.y - position0.y) / area;
+	const float    weight2X  = (position0.y - position1.y) / area;
+	const float    weight0Y  = (position2.x - position1.x) / area;
+	const float    weight1Y  = (position0.x - position2.x) / area;
+	const float    weight2Y  = (position1.x - position0.x) / area;
+
+	gradientX = vertices[0] * weight0X + vertices[1] * weight1X + vertices[2] * weight2X;
+	gradientY = vertices[0] * weight0Y + vertices[1] * weight1Y + vertices[2] * weight2Y;
+}
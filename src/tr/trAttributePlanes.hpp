@@ -0,0 +1,21 @@
+#pragma once
+
+#include "trTransformedVertex.hpp"
+#include <array>
+
+namespace tr
+{
+	// Plane equations of the attributes, which are all linear in screen space once divided by w. They're set up once
+	// per triangle so that traversal only has to add the gradients, and are anchored at the first vertex rather
+	// than at the corner of the screen to keep the values near the triangle precise.
+	struct AttributePlanes
+	{
+	public:
+		                  AttributePlanes(const std::array<TransformedVertex, 3>& vertices);
+
+	public:
+		TransformedVertex origin;
+		TransformedVertex gradientX;
+		TransformedVertex gradientY;
+	};
+}
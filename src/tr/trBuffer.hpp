@@ -1,10 +1,14 @@
 #pragma once
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <memory>
 #include <vector>
 
 #include "trQuadFloat.hpp"
+#include "trQuadInt.hpp"
+#include "trRect.hpp"
 #include "trTextureWrappingMode.hpp"
 #include "..//matrix/Vectors.h"
 
@@ -51,6 +55,53 @@ namespace tr
 			std::fill(m_data.begin(), m_data.end(), value);
 		}
 
+		void fill(const Rect& rect, const T& value)
+		{
+			for (size_t y = rect.getMinY(); y <= rect.getMaxY(); ++y)
+			{
+				T* row = m_data.data() + y * m_width;
+
+				std::fill(row + rect.getMinX(), row + rect.getMaxX() + 1, value);
+			}
+		}
+
+		// Fills a rectangle that won't be read again soon, without bringing it into the cache
+		void fillStreaming(const Rect& rect, const T& value)
+		{
+			static_assert(16 % sizeof(T) == 0, "Values must tile a quad of ints");
+
+			constexpr size_t valuesPerQuad = 16 / sizeof(T);
+
+			T                quadValues[valuesPerQuad];
+			int32_t          quadInts[4];
+
+			std::fill(quadValues, quadValues + valuesPerQuad, value);
+			std::memcpy(quadInts, quadValues, sizeof(quadInts));
+
+			const QuadInt    quad(quadInts[0], quadInts[1], quadInts[2], quadInts[3]);
+
+			for (size_t y = rect.getMinY(); y <= rect.getMaxY(); ++y)
+			{
+				T*       pointer = m_data.data() + y * m_width + rect.getMinX();
+				T* const end     = m_data.data() + y * m_width + rect.getMaxX() + 1;
+
+				// Streaming writes need aligned addresses, so the ends of the row are written normally
+				for (; pointer < end && reinterpret_cast<uintptr_t>(pointer) % 16 != 0; ++pointer)
+				{
+					*pointer = value;
+				}
+
+				for (; end - pointer >= ptrdiff_t(valuesPerQuad); pointer += valuesPerQuad)
+				{
+					quad.writeStreaming(reinterpret_cast<int32_t*>(pointer));
+				}
+
+				std::fill(pointer, end, value);
+			}
+
+			QuadInt::fenceStreamingWrites();
+		}
+
 		T getAt(const size_t x, const size_t y) const
 		{
 			return m_data[y * m_width + x];
@@ -61,6 +112,11 @@ namespace tr
 			return m_data.data();
 		}
 
+		const T* getData() const
+		{
+			return m_data.data();
+		}
+
 		size_t getDataSize() const
 		{
 			return m_data.size() * sizeof(T);
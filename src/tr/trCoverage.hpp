@@ -0,0 +1,11 @@
+#pragma once
+
+namespace tr
+{
+	enum class Coverage
+	{
+		None,
+		Partial,
+		Full
+	};
+}
\ No newline at end of file
@@ -0,0 +1,101 @@
+#include "trCpu.hpp"
+#include <cstdint>
+
+#ifdef TR_SIMD
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+namespace
+{
+	void cpuid(const uint32_t leaf, const uint32_t subleaf, uint32_t registers[4])
+	{
+#if defined(_MSC_VER)
+		int intRegisters[4];
+
+		__cpuidex(intRegisters, int(leaf), int(subleaf));
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			registers[i] = uint32_t(intRegisters[i]);
+		}
+#elif defined(__x86_64__) || defined(__i386__)
+		__cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#else
+		registers[0] = registers[1] = registers[2] = registers[3] = 0;
+#endif
+	}
+
+	// Which register states the OS saves on context switches. The CPU supporting AVX isn't enough without them.
+	uint64_t getEnabledRegisterStates()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#elif defined(__x86_64__) || defined(__i386__)
+		uint32_t low;
+		uint32_t high;
+
+		__asm__("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+
+		return (uint64_t(high) << 32) | low;
+#else
+		return 0;
+#endif
+	}
+}
+#endif
+
+tr::InstructionSet tr::Cpu::getSupportedInstructionSet()
+{
+	static const InstructionSet supportedInstructionSet = detectInstructionSet();
+
+	return supportedInstructionSet;
+}
+
+tr::InstructionSet tr::Cpu::detectInstructionSet()
+{
+#ifndef TR_SIMD
+	return InstructionSet::SSE41;
+#else
+	constexpr uint32_t osxsaveBit = 1u << 27;
+	constexpr uint32_t avxBit     = 1u << 28;
+	constexpr uint32_t avx2Bit    = 1u << 5;
+	constexpr uint64_t avxStates  = 0x06; // XMM and YMM
+
+	uint32_t registers[4];
+
+	cpuid(0, 0, registers);
+
+	const uint32_t maxLeaf = registers[0];
+
+	if (maxLeaf < 7)
+	{
+		return InstructionSet::SSE41;
+	}
+
+	cpuid(1, 0, registers);
+
+	if (!(registers[2] & osxsaveBit) || !(registers[2] & avxBit))
+	{
+		return InstructionSet::SSE41;
+	}
+
+	const uint64_t registerStates = getEnabledRegisterStates();
+
+	if ((registerStates & avxStates) != avxStates)
+	{
+		return InstructionSet::SSE41;
+	}
+
+	cpuid(7, 0, registers);
+
+	if (!(registers[1] & avx2Bit))
+	{
+		return InstructionSet::SSE41;
+	}
+
+	return InstructionSet::AVX2;
+#endif
+}
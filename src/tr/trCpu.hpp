@@ -0,0 +1,28 @@
+#pragma once
+
+#include "trInstructionSet.hpp"
+
+// Functions that use AVX2 intrinsics are marked with this, so the rest of a TR_SIMD build can stay at SSE4.1 and
+// run on any machine. MSVC allows the intrinsics anywhere. Kernels start from a function marked with the flattening
+// version, which inlines everything it calls, so that all of it is compiled for AVX2.
+#if defined(_MSC_VER)
+#define TR_TARGET_AVX2
+#define TR_TARGET_AVX2_FLATTEN
+#else
+#define TR_TARGET_AVX2         __attribute__((target("avx2")))
+#define TR_TARGET_AVX2_FLATTEN __attribute__((target("avx2"), flatten))
+#endif
+
+namespace tr
+{
+	class Cpu
+	{
+	public:
+		// The best instruction set that both this CPU and the build support. Builds without TR_SIMD only have the
+		// SSE4.1 kernels, which use scalar code.
+		static InstructionSet getSupportedInstructionSet();
+
+	private:
+		static InstructionSet detectInstructionSet();
+	};
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+namespace tr
+{
+	// 24-bit fixed-point depth, packed into three bytes with the lowest first. FixedPointDepth converts it.
+	struct Depth24
+	{
+		uint8_t bytes[3];
+	};
+
+	static_assert(sizeof(Depth24) == 3, "24-bit depth is packed without padding");
+}
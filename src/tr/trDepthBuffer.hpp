@@ -1,8 +1,16 @@
 #pragma once
 
 #include "trBuffer.hpp"
+#include "trDepth24.hpp"
+#include <cstdint>
 
 namespace tr
 {
-	typedef Buffer<float> DepthBuffer;
-}
\ No newline at end of file
+	typedef Buffer<float>    DepthBuffer;
+
+	// Fixed-point depth buffers, converted as described in FixedPointDepth. Only drawDepth takes them, and tiles are
+	// still tested in float after converting them. 16-bit depth takes half the memory of float depth, and 24-bit depth,
+	// packed into three bytes, takes three quarters of it.
+	typedef Buffer<uint16_t> DepthBuffer16;
+	typedef Buffer<Depth24>  DepthBuffer24;
+}
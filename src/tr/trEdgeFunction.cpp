@@ -0,0 +1,71 @@
+#include "trEdgeFunction.hpp"
+#include <cmath>
+
+bool tr::EdgeFunction::setup(const std::array<TransformedVertex, 3>& vertices, std::array<EdgeFunction, 3>& edges)
+{
+	constexpr float   subpixelScale = float(1 << s_subpixelBits);
+	constexpr int64_t subpixelMask  = (int64_t(1) << s_subpixelBits) - 1;
+
+	int64_t x[3];
+	int64_t y[3];
+
+	for (size_t i = 0; i < 3; ++i)
+	{
+		x[i] = snap(vertices[i].projectedPosition.x * subpixelScale);
+		y[i] = snap(vertices[i].projectedPosition.y * subpixelScale);
+	}
+
+	const int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+
+	if (area == 0)
+	{
+		return false;
+	}
+
+	const int64_t orientation = area > 0 ? 1 : -1;
+
+	// Same order as the barycentric weights, each edge is opposite the vertex with the same index
+	constexpr size_t edgeVertices[3][2] = { { 1, 2 }, { 2, 0 }, { 0, 1 } };
+
+	for (size_t i = 0; i < 3; ++i)
+	{
+		const size_t  start    = edgeVertices[i][0];
+		const size_t  end      = edgeVertices[i][1];
+		const int64_t deltaX   = x[end] - x[start];
+		const int64_t deltaY   = y[end] - y[start];
+
+		// At a pixel center, the edge function in subpixels squared is 256 * (stepX * x + stepY * y) + constant.
+		// Only its sign matters, so the constant is divided down to whole pixels, rounding towards negative
+		// infinity, which keeps the values small enough to step with 32-bit lanes.
+		const int64_t constant = orientation * (deltaY * x[start] - deltaX * y[start]);
+		const int64_t quotient = constant >> s_subpixelBits;
+		const bool    exact    = (constant & subpixelMask) == 0;
+
+		EdgeFunction& edge     = edges[i];
+
+		edge.stepX = -orientation * deltaY;
+		edge.stepY =  orientation * deltaX;
+
+		// Top-left rule: points exactly on an edge are only inside if the edge is a left edge (the inside is to its
+		// right) or a horizontal top edge (the inside is below it, with y pointing down)
+		const bool    topLeft  = edge.stepX > 0 || (edge.stepX == 0 && edge.stepY > 0);
+
+		edge.constant = quotient - (!topLeft && exact ? 1 : 0);
+	}
+
+	return true;
+}
+
+int64_t tr::EdgeFunction::evaluate(const size_t x, const size_t y) const
+{
+	return stepX * int64_t(x) + stepY * int64_t(y) + constant;
+}
+
+int64_t tr::EdgeFunction::snap(const float subpixels)
+{
+	// Rounds halfway cases away from zero like std::llround, without the library call. Adding a half is exact in
+	// double, so truncating gives the same result.
+	const double value = double(subpixels);
+
+	return int64_t(value >= 0.0 ? value + 0.5 : value - 0.5);
+}
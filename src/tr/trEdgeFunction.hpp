@@ -0,0 +1,31 @@
+#pragma once
+
+#include "trTransformedVertex.hpp"
+#include <array>
+#include <cstdint>
+
+namespace tr
+{
+	// Edge equation of a triangle with its vertices snapped to 1/256 of a pixel, evaluated at pixel centers. It's
+	// oriented so the inside is non-negative, and the fill rule is folded into the constant, so a pixel is covered
+	// when all three are >= 0. Pixels on an edge shared by two triangles belong to exactly one of them: the one
+	// for which it's a top or left edge.
+	struct EdgeFunction
+	{
+	public:
+		static constexpr int64_t s_subpixelBits = 8;
+
+	public:
+		static bool              setup(const std::array<TransformedVertex, 3>& vertices, std::array<EdgeFunction, 3>& edges);
+
+		int64_t                  evaluate(const size_t x, const size_t y) const;
+
+	public:
+		int64_t                  stepX;
+		int64_t                  stepY;
+		int64_t                  constant;
+
+	private:
+		static int64_t           snap(const float subpixels);
+	};
+}
@@ -0,0 +1,111 @@
+#include "trFixedPointDepth.hpp"
+#include "trQuadFloat.hpp"
+#include "trQuadInt.hpp"
+#include <algorithm>
+#include <cmath>
+
+void tr::FixedPointDepth::decode(const uint16_t* source, float* destination, const size_t count)
+{
+	const float     scale     = 1.0f / float(s_steps16);
+	const QuadFloat quadScale = scale;
+	const QuadFloat zero      = float(s_zero16);
+	const QuadFloat minDepth  = -1.0f;
+	const QuadMask  allLanesMask(true);
+
+	size_t          x         = 0;
+
+	for (; x + 4 <= count; x += 4)
+	{
+		((QuadInt(source + x).convertToQuadFloat() - zero) * quadScale).max(minDepth).write(destination + x, allLanesMask);
+	}
+
+	for (; x < count; ++x)
+	{
+		destination[x] = std::max((float(source[x]) - float(s_zero16)) * scale, -1.0f);
+	}
+}
+
+void tr::FixedPointDepth::decode(const Depth24* source, float* destination, const size_t count)
+{
+	const float     scale     = 1.0f / float(s_steps24);
+	const QuadFloat quadScale = scale;
+	const QuadFloat zero      = float(s_zero24);
+	const QuadFloat minDepth  = -1.0f;
+	const QuadMask  allLanesMask(true);
+
+	size_t          x         = 0;
+
+	// Codes fit in a float exactly, so they're converted before the middle code is subtracted
+	for (; x + 4 <= count; x += 4)
+	{
+		const QuadInt codes(unpack(source[x]), unpack(source[x + 1]), unpack(source[x + 2]), unpack(source[x + 3]));
+
+		((codes.convertToQuadFloat() - zero) * quadScale).max(minDepth).write(destination + x, allLanesMask);
+	}
+
+	for (; x < count; ++x)
+	{
+		destination[x] = std::max((float(unpack(source[x])) - float(s_zero24)) * scale, -1.0f);
+	}
+}
+
+void tr::FixedPointDepth::encode(const float* source, uint16_t* destination, const size_t count)
+{
+	const float     scale     = float(s_steps16);
+	const QuadFloat quadScale = scale;
+	const QuadFloat zero      = float(s_zero16);
+	const QuadFloat minDepth  = -1.0f;
+	const QuadFloat maxDepth  = 1.0f;
+
+	size_t          x         = 0;
+
+	// Depths outside the range saturate to its ends. They're clamped before the conversion, which turns values too
+	// large for an integer, like the cleared infinity, into the smallest one.
+	for (; x + 4 <= count; x += 4)
+	{
+		((QuadFloat(source + x).max(minDepth).min(maxDepth) * quadScale).round() + zero).convertToQuadInt().writeSaturated(destination + x);
+	}
+
+	for (; x < count; ++x)
+	{
+		destination[x] = uint16_t(std::round(std::min(std::max(source[x], -1.0f), 1.0f) * scale) + float(s_zero16));
+	}
+}
+
+void tr::FixedPointDepth::encode(const float* source, Depth24* destination, const size_t count)
+{
+	const float     scale     = float(s_steps24);
+	const QuadFloat quadScale = scale;
+	const QuadFloat zero      = float(s_zero24);
+	const QuadFloat minDepth  = -1.0f;
+	const QuadFloat maxDepth  = 1.0f;
+	const QuadMask  allLanesMask(true);
+
+	size_t          x         = 0;
+	int32_t         codes[4];
+
+	for (; x + 4 <= count; x += 4)
+	{
+		((QuadFloat(source + x).max(minDepth).min(maxDepth) * quadScale).round() + zero).convertToQuadInt().write(codes, allLanesMask);
+
+		for (size_t i = 0; i < 4; ++i)
+		{
+			destination[x + i] = pack(codes[i]);
+		}
+	}
+
+	for (; x < count; ++x)
+	{
+		destination[x] = pack(int32_t(std::round(std::min(std::max(source[x], -1.0f), 1.0f) * scale) + float(s_zero24)));
+	}
+}
+
+int32_t tr::FixedPointDepth::unpack(const Depth24& depth)
+{
+	return int32_t(depth.bytes[0]) | (int32_t(depth.bytes[1]) << 8) | (int32_t(depth.bytes[2]) << 16);
+}
+
+tr::Depth24 tr::FixedPointDepth::pack(const int32_t code)
+{
+	return Depth24{ { uint8_t(code), uint8_t(code >> 8), uint8_t(code >> 16) } };
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "trDepth24.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace tr
+{
+	// Converts rows between depth and the fixed-point depth formats. Both spread depths from -1 to 1 evenly over their
+	// codes, with depth 0 on the middle code, like signed normalized formats. So -1, 0 and 1 convert exactly, and every
+	// code is unchanged when converted to depth and back, so tiles can be rendered in float without losing what wasn't
+	// drawn over. The lowest code is spare, and reads as -1 like the one above it.
+	class FixedPointDepth
+	{
+	public:
+		static constexpr int32_t s_zero16  = 0x8000;
+		static constexpr int32_t s_steps16 = 0x7FFF;
+		static constexpr int32_t s_zero24  = 0x800000;
+		static constexpr int32_t s_steps24 = 0x7FFFFF;
+
+	public:
+		static void              decode(const uint16_t* source, float* destination, const size_t count);
+		static void              decode(const Depth24* source, float* destination, const size_t count);
+
+		static void              encode(const float* source, uint16_t* destination, const size_t count);
+		static void              encode(const float* source, Depth24* destination, const size_t count);
+
+	private:
+		static int32_t           unpack(const Depth24& depth);
+		static Depth24           pack(const int32_t code);
+	};
+}
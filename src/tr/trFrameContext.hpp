@@ -0,0 +1,59 @@
+#pragma once
+
+#include "trPendingClear.hpp"
+#include "trRasterizationParams.hpp"
+#include "trTile.hpp"
+#include "trTriangle.hpp"
+#include <vector>
+
+namespace tr
+{
+	// Everything that is queued for one frame. TileManager keeps more than one of these, so the next frame can be
+	// queued while the previous one is still being rendered.
+	template <typename TShader>
+	struct FrameContext
+	{
+		FrameContext() :
+			tileLocalBuffers(false),
+			depthBufferWriteBack(true),
+			depthPrepass(false),
+			depthOnly(false),
+			visibilityBuffer(false),
+			numQueries(0),
+			tileWidth(0),
+			tileHeight(0)
+		{
+		}
+
+		void clear()
+		{
+			for (Tile& tile : tiles)
+			{
+				tile.clear();
+			}
+
+			triangles.clear();
+			shaders.clear();
+			rasterizationParams.clear();
+
+			pendingClear = PendingClear();
+			numQueries   = 0;
+		}
+
+		std::vector<Tile>                tiles;
+		std::vector<Triangle>            triangles;
+		std::vector<TShader>             shaders;
+		std::vector<RasterizationParams> rasterizationParams;
+		bool                             tileLocalBuffers;
+		bool                             depthBufferWriteBack;
+		bool                             depthPrepass;
+		bool                             depthOnly;
+		bool                             visibilityBuffer;
+		PendingClear                     pendingClear;
+		size_t                           numQueries;
+
+		// The tile size the tiles were made for, since each frame is re-tiled when it's next queued
+		size_t                           tileWidth;
+		size_t                           tileHeight;
+	};
+}
\ No newline at end of file
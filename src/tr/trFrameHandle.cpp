@@ -0,0 +1,26 @@
+#include "trFrameHandle.hpp"
+
+tr::FrameHandle::FrameHandle() :
+	m_workerPool(nullptr),
+	m_jobNumber(0)
+{
+}
+
+tr::FrameHandle::FrameHandle(WorkerPool& workerPool, const uint64_t jobNumber) :
+	m_workerPool(&workerPool),
+	m_jobNumber(jobNumber)
+{
+}
+
+bool tr::FrameHandle::isComplete() const
+{
+	return m_workerPool == nullptr || m_workerPool->isComplete(m_jobNumber);
+}
+
+void tr::FrameHandle::wait() const
+{
+	if (!isComplete())
+	{
+		m_workerPool->wait();
+	}
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "trWorkerPool.hpp"
+#include <cstdint>
+
+namespace tr
+{
+	class FrameHandle
+	{
+	public:
+		            FrameHandle();
+		            FrameHandle(WorkerPool& workerPool, const uint64_t jobNumber);
+
+		bool        isComplete() const;
+		void        wait() const;
+
+	private:
+		WorkerPool* m_workerPool;
+		uint64_t    m_jobNumber;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,210 @@
+#include "trHierarchicalDepth.hpp"
+#include <algorithm>
+#include <limits>
+
+tr::HierarchicalDepth::HierarchicalDepth() :
+	m_depthData(nullptr),
+	m_stride(0),
+	m_minX(0),
+	m_minY(0),
+	m_width(0),
+	m_height(0),
+	m_numBlocksX(0),
+	m_numBlocksY(0),
+	m_tileMaxDepth(0.0f),
+	m_tileDirty(true)
+{
+}
+
+void tr::HierarchicalDepth::reset(const float* depthData, const size_t stride, const Rect& bounds)
+{
+	m_depthData  = depthData;
+	m_stride     = stride;
+	m_minX       = bounds.getMinX();
+	m_minY       = bounds.getMinY();
+	m_width      = bounds.getMaxX() - bounds.getMinX() + 1;
+	m_height     = bounds.getMaxY() - bounds.getMinY() + 1;
+	m_numBlocksX = (m_width  + s_blockSize - 1) / s_blockSize;
+	m_numBlocksY = (m_height + s_blockSize - 1) / s_blockSize;
+	m_tileDirty  = true;
+
+	// Nothing is read until a triangle with depth testing asks for it
+	m_quadMaxDepths.resize(m_numBlocksX * m_numBlocksY * s_quadsPerBlock);
+	m_blockMaxDepths.resize(m_numBlocksX * m_numBlocksY);
+	m_unreadBlocks.assign(m_numBlocksX * m_numBlocksY, 1);
+}
+
+void tr::HierarchicalDepth::reset(const float* depthData, const size_t stride, const Rect& bounds, const float clearDepth)
+{
+	reset(depthData, stride, bounds);
+
+	// Quads past the edge of the tile never hold the farthest depth
+	std::fill(m_quadMaxDepths.begin(), m_quadMaxDepths.end(), -std::numeric_limits<float>::infinity());
+
+	for (size_t localY = 0; localY < m_height; ++localY)
+	{
+		for (size_t localX = 0; localX < m_width; localX += 4)
+		{
+			m_quadMaxDepths[getQuadIndex(localX, localY)] = clearDepth;
+		}
+	}
+
+	std::fill(m_blockMaxDepths.begin(), m_blockMaxDepths.end(), clearDepth);
+	std::fill(m_unreadBlocks.begin(), m_unreadBlocks.end(), uint8_t(0));
+
+	m_tileMaxDepth = clearDepth;
+	m_tileDirty    = false;
+}
+
+bool tr::HierarchicalDepth::isOccluded(const Rect& boundingBox, const float minDepth, const bool equalDepthPasses)
+{
+	if (m_tileDirty)
+	{
+		updateTileMaxDepth();
+	}
+
+	if (isBehind(minDepth, m_tileMaxDepth, equalDepthPasses))
+	{
+		return true;
+	}
+
+	const size_t minBlockX = (boundingBox.getMinX() - m_minX) / s_blockSize;
+	const size_t minBlockY = (boundingBox.getMinY() - m_minY) / s_blockSize;
+	const size_t maxBlockX = (std::min(boundingBox.getMaxX() - m_minX, m_width  - 1)) / s_blockSize;
+	const size_t maxBlockY = (std::min(boundingBox.getMaxY() - m_minY, m_height - 1)) / s_blockSize;
+
+	for (size_t blockY = minBlockY; blockY <= maxBlockY; ++blockY)
+	{
+		for (size_t blockX = minBlockX; blockX <= maxBlockX; ++blockX)
+		{
+			if (!isOccluded(blockY * m_numBlocksX + blockX, minDepth, equalDepthPasses))
+			{
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+bool tr::HierarchicalDepth::isOccluded(const size_t blockIndex, const float minDepth, const bool equalDepthPasses)
+{
+	return isBehind(minDepth, getMaxDepth(blockIndex), equalDepthPasses);
+}
+
+size_t tr::HierarchicalDepth::getBlockIndex(const size_t x, const size_t y) const
+{
+	return ((y - m_minY) / s_blockSize) * m_numBlocksX + (x - m_minX) / s_blockSize;
+}
+
+void tr::HierarchicalDepth::update(const size_t x, const size_t y)
+{
+	const size_t blockIndex = getBlockIndex(x, y);
+
+	// The whole block is read when it's first needed anyway
+	if (m_unreadBlocks[blockIndex])
+	{
+		return;
+	}
+
+	const size_t localX           = x - m_minX;
+	const size_t localY           = y - m_minY;
+	float&       quadMaxDepth     = m_quadMaxDepths[getQuadIndex(localX, localY)];
+	float&       blockMaxDepth    = m_blockMaxDepths[blockIndex];
+	const float  oldBlockMaxDepth = blockMaxDepth;
+
+	quadMaxDepth = readQuadMaxDepth(localX, localY);
+
+	if (quadMaxDepth >= blockMaxDepth)
+	{
+		blockMaxDepth = quadMaxDepth;
+	}
+	else
+	{
+		// The quad might have held the farthest depth of the block
+		const float* blockQuadMaxDepths = m_quadMaxDepths.data() + blockIndex * s_quadsPerBlock;
+
+		blockMaxDepth = *std::max_element(blockQuadMaxDepths, blockQuadMaxDepths + s_quadsPerBlock);
+	}
+
+	if (m_tileDirty)
+	{
+		return;
+	}
+
+	if (blockMaxDepth >= m_tileMaxDepth)
+	{
+		m_tileMaxDepth = blockMaxDepth;
+	}
+	else if (oldBlockMaxDepth == m_tileMaxDepth)
+	{
+		m_tileDirty = true;
+	}
+}
+
+float tr::HierarchicalDepth::getMaxDepth(const size_t blockIndex)
+{
+	if (m_unreadBlocks[blockIndex])
+	{
+		const size_t blockX             = blockIndex % m_numBlocksX;
+		const size_t blockY             = blockIndex / m_numBlocksX;
+		float*       blockQuadMaxDepths = m_quadMaxDepths.data() + blockIndex * s_quadsPerBlock;
+
+		// Quads past the edge of the tile never hold the farthest depth
+		std::fill(blockQuadMaxDepths, blockQuadMaxDepths + s_quadsPerBlock, -std::numeric_limits<float>::infinity());
+
+		for (size_t localY = blockY * s_blockSize; localY < std::min((blockY + 1) * s_blockSize, m_height); ++localY)
+		{
+			for (size_t localX = blockX * s_blockSize; localX < std::min((blockX + 1) * s_blockSize, m_width); localX += 4)
+			{
+				m_quadMaxDepths[getQuadIndex(localX, localY)] = readQuadMaxDepth(localX, localY);
+			}
+		}
+
+		m_blockMaxDepths[blockIndex] = *std::max_element(blockQuadMaxDepths, blockQuadMaxDepths + s_quadsPerBlock);
+		m_unreadBlocks[blockIndex]   = 0;
+	}
+
+	return m_blockMaxDepths[blockIndex];
+}
+
+float tr::HierarchicalDepth::readQuadMaxDepth(const size_t localX, const size_t localY) const
+{
+	const float* depth     = m_depthData + localY * m_stride + localX;
+	const size_t numPixels = std::min(m_width - localX, size_t(4));
+
+	float        maxDepth  = depth[0];
+
+	for (size_t x = 1; x < numPixels; ++x)
+	{
+		maxDepth = std::max(maxDepth, depth[x]);
+	}
+
+	return maxDepth;
+}
+
+size_t tr::HierarchicalDepth::getQuadIndex(const size_t localX, const size_t localY) const
+{
+	const size_t blockIndex = (localY / s_blockSize) * m_numBlocksX + localX / s_blockSize;
+
+	return blockIndex * s_quadsPerBlock + (localY % s_blockSize) * (s_blockSize / 4) + (localX % s_blockSize) / 4;
+}
+
+void tr::HierarchicalDepth::updateTileMaxDepth()
+{
+	// Only needed when the block that held the farthest depth got nearer, and blocks that were already read only cost
+	// their maximum
+	m_tileMaxDepth = getMaxDepth(0);
+
+	for (size_t blockIndex = 1; blockIndex < m_blockMaxDepths.size(); ++blockIndex)
+	{
+		m_tileMaxDepth = std::max(m_tileMaxDepth, getMaxDepth(blockIndex));
+	}
+
+	m_tileDirty = false;
+}
+
+bool tr::HierarchicalDepth::isBehind(const float minDepth, const float maxDepth, const bool equalDepthPasses)
+{
+	return equalDepthPasses ? minDepth > maxDepth : minDepth >= maxDepth;
+}
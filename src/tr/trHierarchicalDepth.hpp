@@ -0,0 +1,56 @@
+#pragma once
+
+#include "trRect.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace tr
+{
+	// Farthest depth of every 8x8 block of a tile, and of the whole tile, so triangles and quads that are behind
+	// everything already drawn there can be rejected before interpolating any attributes. Shaders write depth
+	// themselves, so a quad that was drawn to is read back from the depth buffer, and the farthest depth of each row of
+	// a quad is kept to update its block from.
+	class HierarchicalDepth
+	{
+	public:
+		static constexpr size_t s_blockSize     = 8;
+		static constexpr size_t s_quadsPerBlock = s_blockSize * s_blockSize / 4;
+
+	public:
+		                        HierarchicalDepth();
+
+		void                    reset(const float* depthData, const size_t stride, const Rect& bounds);
+		// For tiles that were just cleared, so nothing has to be read back
+		void                    reset(const float* depthData, const size_t stride, const Rect& bounds, const float clearDepth);
+
+		// Depths equal to the farthest stored one are occluded unless equal depths pass the depth test
+		bool                    isOccluded(const Rect& boundingBox, const float minDepth, const bool equalDepthPasses);
+		bool                    isOccluded(const size_t blockIndex, const float minDepth, const bool equalDepthPasses);
+
+		size_t                  getBlockIndex(const size_t x, const size_t y) const;
+		void                    update(const size_t x, const size_t y);
+
+	private:
+		float                   getMaxDepth(const size_t blockIndex);
+		float                   readQuadMaxDepth(const size_t localX, const size_t localY) const;
+		size_t                  getQuadIndex(const size_t localX, const size_t localY) const;
+		void                    updateTileMaxDepth();
+
+		static bool             isBehind(const float minDepth, const float maxDepth, const bool equalDepthPasses);
+
+	private:
+		const float*            m_depthData;
+		size_t                  m_stride;
+		size_t                  m_minX;
+		size_t                  m_minY;
+		size_t                  m_width;
+		size_t                  m_height;
+		size_t                  m_numBlocksX;
+		size_t                  m_numBlocksY;
+		std::vector<float>      m_quadMaxDepths;
+		std::vector<float>      m_blockMaxDepths;
+		std::vector<uint8_t>    m_unreadBlocks;
+		float                   m_tileMaxDepth;
+		bool                    m_tileDirty;
+	};
+}
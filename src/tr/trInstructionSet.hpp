@@ -0,0 +1,11 @@
+#pragma once
+
+namespace tr
+{
+	// Instruction sets the rasterizer has kernels for. CPUs with AVX-512 run the AVX2 kernels.
+	enum class InstructionSet
+	{
+		SSE41,
+		AVX2
+	};
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "trCpu.hpp"
+
+namespace tr
+{
+	// Runs a kernel compiled for its instruction set. The AVX2 version inlines everything the kernel calls into
+	// itself, so all of the kernel is compiled for AVX2 without the rest of the build needing it.
+	template <InstructionSet instructionSet>
+	class KernelTarget
+	{
+	public:
+		template <typename TKernel>
+		static void run(const TKernel& kernel)
+		{
+			kernel();
+		}
+	};
+
+#ifdef TR_SIMD
+	template <>
+	class KernelTarget<InstructionSet::AVX2>
+	{
+	public:
+		template <typename TKernel>
+		TR_TARGET_AVX2_FLATTEN static void run(const TKernel& kernel)
+		{
+			kernel();
+		}
+	};
+#endif
+}
@@ -0,0 +1,198 @@
+#include "trOcclusionCuller.hpp"
+#include "trQuadFloat.hpp"
+#include "trFixedPointDepth.hpp"
+#include <algorithm>
+#include <cmath>
+
+tr::OcclusionCuller::OcclusionCuller() :
+	m_viewProjectionMatrix(),
+	m_bufferHalfWidth(0.0f),
+	m_bufferHalfHeight(0.0f),
+	m_width(0),
+	m_height(0),
+	m_numBlocksX(0),
+	m_numBlocksY(0),
+	m_blockStride(0),
+	m_maxDepth(s_paddingDepth)
+{
+}
+
+void tr::OcclusionCuller::update(const DepthBuffer& depthBuffer, const Matrix4& viewProjectionMatrix)
+{
+	updateBlocks(depthBuffer, viewProjectionMatrix);
+}
+
+void tr::OcclusionCuller::update(const DepthBuffer16& depthBuffer, const Matrix4& viewProjectionMatrix)
+{
+	updateBlocks(depthBuffer, viewProjectionMatrix);
+}
+
+void tr::OcclusionCuller::update(const DepthBuffer24& depthBuffer, const Matrix4& viewProjectionMatrix)
+{
+	updateBlocks(depthBuffer, viewProjectionMatrix);
+}
+
+template <typename T>
+void tr::OcclusionCuller::updateBlocks(const Buffer<T>& depthBuffer, const Matrix4& viewProjectionMatrix)
+{
+	m_viewProjectionMatrix = viewProjectionMatrix;
+	m_width                = size_t(depthBuffer.getWidth());
+	m_height               = size_t(depthBuffer.getHeight());
+	m_bufferHalfWidth      = float(m_width)  / 2.0f;
+	m_bufferHalfHeight     = float(m_height) / 2.0f;
+	m_numBlocksX           = (m_width  + s_blockSize - 1) / s_blockSize;
+	m_numBlocksY           = (m_height + s_blockSize - 1) / s_blockSize;
+	m_blockStride          = (m_numBlocksX + 3) & ~size_t(3);
+	m_maxDepth             = s_paddingDepth;
+
+	const float paddingDepth = s_paddingDepth;
+
+	m_blockMaxDepths.assign(m_blockStride * m_numBlocksY, paddingDepth);
+	m_rowMaxDepths.resize(m_numBlocksX * s_blockSize);
+	m_decodedRow.resize(m_width);
+
+	const T* depthData = depthBuffer.getData();
+
+	for (size_t blockY = 0; blockY < m_numBlocksY; ++blockY)
+	{
+		std::fill(m_rowMaxDepths.begin(), m_rowMaxDepths.end(), paddingDepth);
+
+		// Each block is as wide as a quad, so the rows are reduced first and each block is then one horizontal max
+		for (size_t y = blockY * s_blockSize; y < std::min((blockY + 1) * s_blockSize, m_height); ++y)
+		{
+			const float* row = getDepthRow(depthData + y * m_width);
+
+			for (size_t x = 0; x < m_width; ++x)
+			{
+				m_rowMaxDepths[x] = std::max(m_rowMaxDepths[x], row[x]);
+			}
+		}
+
+		float* blockMaxDepths = m_blockMaxDepths.data() + blockY * m_blockStride;
+
+		for (size_t blockX = 0; blockX < m_numBlocksX; ++blockX)
+		{
+			blockMaxDepths[blockX] = QuadFloat(m_rowMaxDepths.data() + blockX * s_blockSize).horizontalMax();
+			m_maxDepth             = std::max(m_maxDepth, blockMaxDepths[blockX]);
+		}
+	}
+}
+
+const float* tr::OcclusionCuller::getDepthRow(const float* row)
+{
+	return row;
+}
+
+const float* tr::OcclusionCuller::getDepthRow(const uint16_t* row)
+{
+	FixedPointDepth::decode(row, m_decodedRow.data(), m_width);
+
+	return m_decodedRow.data();
+}
+
+const float* tr::OcclusionCuller::getDepthRow(const Depth24* row)
+{
+	FixedPointDepth::decode(row, m_decodedRow.data(), m_width);
+
+	return m_decodedRow.data();
+}
+
+bool tr::OcclusionCuller::isVisible(const Vector3& boxMin, const Vector3& boxMax) const
+{
+	return isVisibleProjected(boxMin, boxMax, m_viewProjectionMatrix);
+}
+
+bool tr::OcclusionCuller::isVisible(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& modelMatrix) const
+{
+	return isVisibleProjected(boxMin, boxMax, m_viewProjectionMatrix * modelMatrix);
+}
+
+bool tr::OcclusionCuller::isVisibleProjected(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& modelViewProjectionMatrix) const
+{
+	// Nothing can be hidden before the first update
+	if (m_blockMaxDepths.empty())
+	{
+		return true;
+	}
+
+	const float*    m        = modelViewProjectionMatrix.get();
+
+	// The low quad holds the corners at the box's minimum z and the high quad those at its maximum z, which share
+	// their x and y terms
+	const QuadFloat cornersX(boxMin.x, boxMax.x, boxMin.x, boxMax.x);
+	const QuadFloat cornersY(boxMin.y, boxMin.y, boxMax.y, boxMax.y);
+
+	const QuadFloat sharedX  = cornersX * m[0] + cornersY * m[4] + m[12];
+	const QuadFloat sharedY  = cornersX * m[1] + cornersY * m[5] + m[13];
+	const QuadFloat sharedZ  = cornersX * m[2] + cornersY * m[6] + m[14];
+	const QuadFloat sharedW  = cornersX * m[3] + cornersY * m[7] + m[15];
+
+	const QuadFloat lowW     = sharedW + m[11] * boxMin.z;
+	const QuadFloat highW    = sharedW + m[11] * boxMax.z;
+
+	// Boxes that reach behind the camera can't be projected, and are close enough to be worth drawing anyway
+	constexpr float minW     = 0.0001f;
+
+	if (lowW.min(highW).lessThan(minW).moveMask())
+	{
+		return true;
+	}
+
+	const QuadFloat lowInverseW  = QuadFloat(1.0f) / lowW;
+	const QuadFloat highInverseW = QuadFloat(1.0f) / highW;
+
+	const QuadFloat lowX         = (sharedX + m[8]  * boxMin.z) * lowInverseW;
+	const QuadFloat highX        = (sharedX + m[8]  * boxMax.z) * highInverseW;
+	const QuadFloat lowY         = (sharedY + m[9]  * boxMin.z) * lowInverseW;
+	const QuadFloat highY        = (sharedY + m[9]  * boxMax.z) * highInverseW;
+	const QuadFloat lowZ         = (sharedZ + m[10] * boxMin.z) * lowInverseW;
+	const QuadFloat highZ        = (sharedZ + m[10] * boxMax.z) * highInverseW;
+
+	// Same viewport transformation as the rasterizer, with y pointing down
+	const float     minScreenX   = lowX.min(highX).horizontalMin() * m_bufferHalfWidth  + m_bufferHalfWidth;
+	const float     maxScreenX   = lowX.max(highX).horizontalMax() * m_bufferHalfWidth  + m_bufferHalfWidth;
+	const float     minScreenY   = m_bufferHalfHeight - lowY.max(highY).horizontalMax() * m_bufferHalfHeight;
+	const float     maxScreenY   = m_bufferHalfHeight - lowY.min(highY).horizontalMin() * m_bufferHalfHeight;
+	// Pulled a little closer, so that rounding in the projection can't hide a box that touches the occluders
+	const float     minDepth     = lowZ.min(highZ).horizontalMin() - s_depthMargin;
+
+	if (maxScreenX < 0.0f || minScreenX >= float(m_width) || maxScreenY < 0.0f || minScreenY >= float(m_height) || minDepth > 1.0f)
+	{
+		return false;
+	}
+
+	if (minDepth >= m_maxDepth)
+	{
+		return false;
+	}
+
+	// Every pixel the box touches is included, whether or not it covers the pixel's center
+	const size_t    minBlockX    = size_t(std::max(minScreenX, 0.0f)) / s_blockSize;
+	const size_t    minBlockY    = size_t(std::max(minScreenY, 0.0f)) / s_blockSize;
+	const size_t    maxBlockX    = size_t(std::min(maxScreenX, float(m_width  - 1))) / s_blockSize;
+	const size_t    maxBlockY    = size_t(std::min(maxScreenY, float(m_height - 1))) / s_blockSize;
+
+	const QuadFloat laneOffsets(0.0f, 1.0f, 2.0f, 3.0f);
+	const QuadFloat blockRangeMin(float(minBlockX) - 0.5f);
+	const QuadFloat blockRangeMax(float(maxBlockX) + 0.5f);
+	const QuadFloat boxDepth(minDepth);
+
+	for (size_t blockY = minBlockY; blockY <= maxBlockY; ++blockY)
+	{
+		const float* blockMaxDepths = m_blockMaxDepths.data() + blockY * m_blockStride;
+
+		// Rows of blocks are padded to whole quads, so four blocks are tested at a time from aligned addresses
+		for (size_t blockX = minBlockX & ~size_t(3); blockX <= maxBlockX; blockX += 4)
+		{
+			const QuadFloat blockIndices = laneOffsets + float(blockX);
+			const QuadMask  inBox        = blockIndices.greaterThan(blockRangeMin) & blockIndices.lessThan(blockRangeMax);
+
+			if ((QuadFloat(blockMaxDepths + blockX).greaterThan(boxDepth) & inBox).moveMask())
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
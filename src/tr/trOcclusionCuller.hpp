@@ -0,0 +1,58 @@
+#pragma once
+
+#include "trDepthBuffer.hpp"
+#include "../matrix/Matrices.h"
+#include <limits>
+#include <vector>
+
+namespace tr
+{
+	// Tests bounding boxes against the depth of a few large occluders, so meshes hidden behind them can be skipped
+	// before they're queued. The occluders are drawn into a small depth buffer, float or fixed-point, with
+	// Rasterizer::queue() without a shader and Rasterizer::drawDepth(), with the same view and projection the boxes
+	// are tested with. The tests are conservative, a box is only hidden if it's outside the view or behind the
+	// farthest occluder depth in every block of pixels it could cover.
+	class OcclusionCuller
+	{
+	public:
+		static constexpr size_t s_blockSize = 4;
+
+	public:
+		                        OcclusionCuller();
+
+		void                    update(const DepthBuffer& depthBuffer, const Matrix4& viewProjectionMatrix);
+		void                    update(const DepthBuffer16& depthBuffer, const Matrix4& viewProjectionMatrix);
+		void                    update(const DepthBuffer24& depthBuffer, const Matrix4& viewProjectionMatrix);
+
+		bool                    isVisible(const Vector3& boxMin, const Vector3& boxMax) const;
+		bool                    isVisible(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& modelMatrix) const;
+
+	private:
+		template <typename T>
+		void                    updateBlocks(const Buffer<T>& depthBuffer, const Matrix4& viewProjectionMatrix);
+
+		const float*            getDepthRow(const float* row);
+		const float*            getDepthRow(const uint16_t* row);
+		const float*            getDepthRow(const Depth24* row);
+
+		bool                    isVisibleProjected(const Vector3& boxMin, const Vector3& boxMax, const Matrix4& modelViewProjectionMatrix) const;
+
+	private:
+		// Lanes past the end of a row of blocks are padded with the lowest depth, which never passes a depth test
+		static constexpr float  s_paddingDepth = -std::numeric_limits<float>::max();
+		static constexpr float  s_depthMargin  = 1.0e-5f;
+
+		Matrix4                 m_viewProjectionMatrix;
+		float                   m_bufferHalfWidth;
+		float                   m_bufferHalfHeight;
+		size_t                  m_width;
+		size_t                  m_height;
+		size_t                  m_numBlocksX;
+		size_t                  m_numBlocksY;
+		size_t                  m_blockStride;
+		std::vector<float>      m_blockMaxDepths;
+		std::vector<float>      m_rowMaxDepths;
+		std::vector<float>      m_decodedRow;
+		float                   m_maxDepth;
+	};
+}
@@ -0,0 +1,88 @@
+#include "trOctFloat.hpp"
+
+tr::OctFloat<tr::InstructionSet::SSE41>::OctFloat(const float a) :
+	m_low(a),
+	m_high(a)
+{
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41>::OctFloat(const QuadFloat& low, const QuadFloat& high) :
+	m_low(low),
+	m_high(high)
+{
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41>::OctFloat(const float* const pointer, const Mask& mask) :
+	m_low(pointer, mask.getLow()),
+	m_high(pointer + 4, mask.getHigh())
+{
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41>& tr::OctFloat<tr::InstructionSet::SSE41>::operator+=(const OctFloat& rhs)
+{
+	m_low  += rhs.m_low;
+	m_high += rhs.m_high;
+
+	return *this;
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::operator+(const OctFloat& rhs) const
+{
+	return OctFloat(m_low + rhs.m_low, m_high + rhs.m_high);
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::operator*(const OctFloat& rhs) const
+{
+	return OctFloat(m_low * rhs.m_low, m_high * rhs.m_high);
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::operator/(const OctFloat& rhs) const
+{
+	return OctFloat(m_low / rhs.m_low, m_high / rhs.m_high);
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::operator&(const OctFloat& rhs) const
+{
+	return OctFloat(m_low & rhs.m_low, m_high & rhs.m_high);
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::operator|(const OctFloat& rhs) const
+{
+	return OctFloat(m_low | rhs.m_low, m_high | rhs.m_high);
+}
+
+tr::OctMask<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::greaterThan(const OctFloat& rhs) const
+{
+	return Mask(m_low.greaterThan(rhs.m_low), m_high.greaterThan(rhs.m_high));
+}
+
+tr::OctMask<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::equal(const OctFloat& rhs) const
+{
+	return Mask(m_low.equal(rhs.m_low), m_high.equal(rhs.m_high));
+}
+
+tr::OctMask<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::castToMask() const
+{
+	return Mask(m_low.castToMask(), m_high.castToMask());
+}
+
+tr::OctFloat<tr::InstructionSet::SSE41> tr::OctFloat<tr::InstructionSet::SSE41>::abs() const
+{
+	return OctFloat(m_low.abs(), m_high.abs());
+}
+
+tr::QuadFloat tr::OctFloat<tr::InstructionSet::SSE41>::getLow() const
+{
+	return m_low;
+}
+
+tr::QuadFloat tr::OctFloat<tr::InstructionSet::SSE41>::getHigh() const
+{
+	return m_high;
+}
+
+void tr::OctFloat<tr::InstructionSet::SSE41>::write(float* const pointer, const Mask& mask) const
+{
+	m_low.write(pointer, mask.getLow());
+	m_high.write(pointer + 4, mask.getHigh());
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "trOctMask.hpp"
+#include "trQuadFloat.hpp"
+
+namespace tr
+{
+	// Eight floats, with one type per kernel instruction set like OctMask
+	template <InstructionSet instructionSet>
+	class OctFloat;
+
+	template <>
+	class OctFloat<InstructionSet::SSE41>
+	{
+	public:
+		typedef OctMask<InstructionSet::SSE41> Mask;
+
+	public:
+		                     OctFloat(const float a);
+		                     OctFloat(const QuadFloat& low, const QuadFloat& high);
+		                     OctFloat(const float* const pointer, const Mask& mask);
+
+		OctFloat&            operator+=(const OctFloat& rhs);
+		OctFloat             operator+(const OctFloat& rhs) const;
+		OctFloat             operator*(const OctFloat& rhs) const;
+		OctFloat             operator/(const OctFloat& rhs) const;
+
+		OctFloat             operator&(const OctFloat& rhs) const;
+		OctFloat             operator|(const OctFloat& rhs) const;
+
+		Mask                 greaterThan(const OctFloat& rhs) const;
+		Mask                 equal(const OctFloat& rhs) const;
+
+		Mask                 castToMask() const;
+
+		OctFloat             abs() const;
+
+		QuadFloat            getLow() const;
+		QuadFloat            getHigh() const;
+
+		void                 write(float* const pointer, const Mask& mask) const;
+
+	private:
+		QuadFloat            m_low;
+		QuadFloat            m_high;
+	};
+
+#ifdef TR_SIMD
+	// Defined here, so that the AVX2 kernels can inline it
+	template <>
+	class OctFloat<InstructionSet::AVX2>
+	{
+	public:
+		typedef OctMask<InstructionSet::AVX2> Mask;
+
+	public:
+		TR_TARGET_AVX2 OctFloat(const float a) :
+			m_data(_mm256_set1_ps(a))
+		{
+		}
+
+		TR_TARGET_AVX2 OctFloat(const QuadFloat& low, const QuadFloat& high) :
+			m_data(_mm256_insertf128_ps(_mm256_castps128_ps256(low.getData()), high.getData(), 1))
+		{
+		}
+
+		TR_TARGET_AVX2 OctFloat(const float* const pointer, const Mask& mask) :
+			m_data(_mm256_maskload_ps(pointer, _mm256_castps_si256(mask.getData())))
+		{
+		}
+
+		TR_TARGET_AVX2 OctFloat(const __m256 data) :
+			m_data(data)
+		{
+		}
+
+		TR_TARGET_AVX2 OctFloat& operator+=(const OctFloat& rhs)
+		{
+			m_data = _mm256_add_ps(m_data, rhs.m_data);
+
+			return *this;
+		}
+
+		TR_TARGET_AVX2 OctFloat operator+(const OctFloat& rhs) const
+		{
+			return OctFloat(_mm256_add_ps(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 OctFloat operator*(const OctFloat& rhs) const
+		{
+			return OctFloat(_mm256_mul_ps(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 OctFloat operator/(const OctFloat& rhs) const
+		{
+			return OctFloat(_mm256_div_ps(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 OctFloat operator&(const OctFloat& rhs) const
+		{
+			return OctFloat(_mm256_and_ps(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 OctFloat operator|(const OctFloat& rhs) const
+		{
+			return OctFloat(_mm256_or_ps(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 Mask greaterThan(const OctFloat& rhs) const
+		{
+			return Mask(_mm256_cmp_ps(m_data, rhs.m_data, _CMP_GT_OQ));
+		}
+
+		TR_TARGET_AVX2 Mask equal(const OctFloat& rhs) const
+		{
+			return Mask(_mm256_cmp_ps(m_data, rhs.m_data, _CMP_EQ_OQ));
+		}
+
+		TR_TARGET_AVX2 Mask castToMask() const
+		{
+			return Mask(m_data);
+		}
+
+		TR_TARGET_AVX2 OctFloat abs() const
+		{
+			return OctFloat(_mm256_and_ps(m_data, _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff))));
+		}
+
+		TR_TARGET_AVX2 QuadFloat getLow() const
+		{
+			return QuadFloat(_mm256_castps256_ps128(m_data));
+		}
+
+		TR_TARGET_AVX2 QuadFloat getHigh() const
+		{
+			return QuadFloat(_mm256_extractf128_ps(m_data, 1));
+		}
+
+		TR_TARGET_AVX2 void write(float* const pointer, const Mask& mask) const
+		{
+			_mm256_maskstore_ps(pointer, _mm256_castps_si256(mask.getData()), m_data);
+		}
+
+	private:
+		__m256 m_data;
+	};
+#endif
+}
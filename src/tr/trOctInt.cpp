@@ -0,0 +1,29 @@
+#include "trOctInt.hpp"
+
+tr::OctInt<tr::InstructionSet::SSE41>::OctInt(const int32_t a) :
+	m_low(a),
+	m_high(a)
+{
+}
+
+tr::OctInt<tr::InstructionSet::SSE41>::OctInt(const QuadInt& low, const QuadInt& high) :
+	m_low(low),
+	m_high(high)
+{
+}
+
+tr::OctInt<tr::InstructionSet::SSE41> tr::OctInt<tr::InstructionSet::SSE41>::operator+(const OctInt& rhs) const
+{
+	return OctInt(m_low + rhs.m_low, m_high + rhs.m_high);
+}
+
+tr::OctInt<tr::InstructionSet::SSE41> tr::OctInt<tr::InstructionSet::SSE41>::operator|(const OctInt& rhs) const
+{
+	return OctInt(m_low | rhs.m_low, m_high | rhs.m_high);
+}
+
+// Lanes with the sign bit set
+tr::OctMask<tr::InstructionSet::SSE41> tr::OctInt<tr::InstructionSet::SSE41>::castToMask() const
+{
+	return Mask(m_low.castToMask(), m_high.castToMask());
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "trOctMask.hpp"
+#include "trQuadInt.hpp"
+
+namespace tr
+{
+	// Eight 32-bit integers, with one type per kernel instruction set like OctMask
+	template <InstructionSet instructionSet>
+	class OctInt;
+
+	template <>
+	class OctInt<InstructionSet::SSE41>
+	{
+	public:
+		typedef OctMask<InstructionSet::SSE41> Mask;
+
+	public:
+		                     OctInt(const int32_t a);
+		                     OctInt(const QuadInt& low, const QuadInt& high);
+
+		OctInt               operator+(const OctInt& rhs) const;
+		OctInt               operator|(const OctInt& rhs) const;
+
+		Mask                 castToMask() const;
+
+	private:
+		QuadInt              m_low;
+		QuadInt              m_high;
+	};
+
+#ifdef TR_SIMD
+	// Defined here, so that the AVX2 kernels can inline it
+	template <>
+	class OctInt<InstructionSet::AVX2>
+	{
+	public:
+		typedef OctMask<InstructionSet::AVX2> Mask;
+
+	public:
+		TR_TARGET_AVX2 OctInt(const int32_t a) :
+			m_data(_mm256_set1_epi32(a))
+		{
+		}
+
+		TR_TARGET_AVX2 OctInt(const QuadInt& low, const QuadInt& high) :
+			m_data(_mm256_inserti128_si256(_mm256_castsi128_si256(low.getData()), high.getData(), 1))
+		{
+		}
+
+		TR_TARGET_AVX2 OctInt(const __m256i data) :
+			m_data(data)
+		{
+		}
+
+		TR_TARGET_AVX2 OctInt operator+(const OctInt& rhs) const
+		{
+			return OctInt(_mm256_add_epi32(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 OctInt operator|(const OctInt& rhs) const
+		{
+			return OctInt(_mm256_or_si256(m_data, rhs.m_data));
+		}
+
+		// Lanes with the sign bit set
+		TR_TARGET_AVX2 Mask castToMask() const
+		{
+			return Mask(_mm256_castsi256_ps(m_data));
+		}
+
+	private:
+		__m256i m_data;
+	};
+#endif
+}
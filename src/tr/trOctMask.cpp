@@ -0,0 +1,56 @@
+#include "trOctMask.hpp"
+
+tr::OctMask<tr::InstructionSet::SSE41>::OctMask(const bool a) :
+	m_low(a),
+	m_high(a)
+{
+}
+
+tr::OctMask<tr::InstructionSet::SSE41>::OctMask(const QuadMask& low, const QuadMask& high) :
+	m_low(low),
+	m_high(high)
+{
+}
+
+tr::OctMask<tr::InstructionSet::SSE41>& tr::OctMask<tr::InstructionSet::SSE41>::operator&=(const OctMask& rhs)
+{
+	m_low  &= rhs.m_low;
+	m_high &= rhs.m_high;
+
+	return *this;
+}
+
+tr::OctMask<tr::InstructionSet::SSE41> tr::OctMask<tr::InstructionSet::SSE41>::operator&(const OctMask& rhs) const
+{
+	return OctMask(m_low & rhs.m_low, m_high & rhs.m_high);
+}
+
+tr::OctMask<tr::InstructionSet::SSE41> tr::OctMask<tr::InstructionSet::SSE41>::operator|(const OctMask& rhs) const
+{
+	return OctMask(m_low | rhs.m_low, m_high | rhs.m_high);
+}
+
+tr::OctMask<tr::InstructionSet::SSE41> tr::OctMask<tr::InstructionSet::SSE41>::operator~() const
+{
+	return OctMask(~m_low, ~m_high);
+}
+
+bool tr::OctMask<tr::InstructionSet::SSE41>::moveMask() const
+{
+	return m_low.moveMask() || m_high.moveMask();
+}
+
+size_t tr::OctMask<tr::InstructionSet::SSE41>::count() const
+{
+	return m_low.count() + m_high.count();
+}
+
+tr::QuadMask tr::OctMask<tr::InstructionSet::SSE41>::getLow() const
+{
+	return m_low;
+}
+
+tr::QuadMask tr::OctMask<tr::InstructionSet::SSE41>::getHigh() const
+{
+	return m_high;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "trCpu.hpp"
+#include "trQuadMask.hpp"
+#include <bitset>
+
+namespace tr
+{
+	// Mask for eight lanes, two quads side by side. The rasterizer covers eight pixels per step with these and hands
+	// the halves to the shader as quads. Each kernel has its own: the SSE4.1 one is a pair of quad masks, and the AVX2
+	// one, which only TR_SIMD builds have, holds all eight lanes in one register. Eight is the only width; there are
+	// no sixteen-lane types, so AVX-512 CPUs run the AVX2 kernel, and shaders, colors and textures stay four wide.
+	template <InstructionSet instructionSet>
+	class OctMask;
+
+	template <>
+	class OctMask<InstructionSet::SSE41>
+	{
+	public:
+		                    OctMask(const bool a);
+		                    OctMask(const QuadMask& low, const QuadMask& high);
+
+		OctMask&            operator&=(const OctMask& rhs);
+		OctMask             operator&(const OctMask& rhs) const;
+		OctMask             operator|(const OctMask& rhs) const;
+		OctMask             operator~() const;
+
+		bool                moveMask() const;
+		size_t              count() const;
+
+		QuadMask            getLow() const;
+		QuadMask            getHigh() const;
+
+	private:
+		QuadMask            m_low;
+		QuadMask            m_high;
+	};
+
+#ifdef TR_SIMD
+	// Defined here, so that the AVX2 kernels can inline it
+	template <>
+	class OctMask<InstructionSet::AVX2>
+	{
+	public:
+		TR_TARGET_AVX2 OctMask(const bool a) :
+			m_data(_mm256_castsi256_ps(_mm256_set1_epi32(a ? -1 : 0)))
+		{
+		}
+
+		TR_TARGET_AVX2 OctMask(const QuadMask& low, const QuadMask& high) :
+			m_data(_mm256_insertf128_ps(_mm256_castps128_ps256(low.getData()), high.getData(), 1))
+		{
+		}
+
+		TR_TARGET_AVX2 OctMask(const __m256 data) :
+			m_data(data)
+		{
+		}
+
+		TR_TARGET_AVX2 OctMask& operator&=(const OctMask& rhs)
+		{
+			m_data = _mm256_and_ps(m_data, rhs.m_data);
+
+			return *this;
+		}
+
+		TR_TARGET_AVX2 OctMask operator&(const OctMask& rhs) const
+		{
+			return OctMask(_mm256_and_ps(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 OctMask operator|(const OctMask& rhs) const
+		{
+			return OctMask(_mm256_or_ps(m_data, rhs.m_data));
+		}
+
+		TR_TARGET_AVX2 OctMask operator~() const
+		{
+			return OctMask(_mm256_xor_ps(m_data, _mm256_castsi256_ps(_mm256_set1_epi32(-1))));
+		}
+
+		TR_TARGET_AVX2 bool moveMask() const
+		{
+			return _mm256_movemask_ps(m_data) > 0;
+		}
+
+		TR_TARGET_AVX2 size_t count() const
+		{
+			return std::bitset<8>(unsigned(_mm256_movemask_ps(m_data))).count();
+		}
+
+		TR_TARGET_AVX2 QuadMask getLow() const
+		{
+			return QuadMask(_mm256_castps256_ps128(m_data));
+		}
+
+		TR_TARGET_AVX2 QuadMask getHigh() const
+		{
+			return QuadMask(_mm256_extractf128_ps(m_data, 1));
+		}
+
+		TR_TARGET_AVX2 __m256 getData() const
+		{
+			return m_data;
+		}
+
+	private:
+		__m256 m_data;
+	};
+#endif
+}
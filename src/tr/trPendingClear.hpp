@@ -0,0 +1,23 @@
+#pragma once
+
+#include "trColor.hpp"
+
+namespace tr
+{
+	// Values the buffers of a frame are cleared to by the render threads, each tile just before it's rendered
+	struct PendingClear
+	{
+		PendingClear() :
+			clearColor(false),
+			clearDepth(false),
+			color(),
+			depth(1.0f)
+		{
+		}
+
+		bool  clearColor;
+		bool  clearDepth;
+		Color color;
+		float depth;
+	};
+}
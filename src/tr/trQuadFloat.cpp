@@ -1,9 +1,55 @@
 #include "trQuadFloat.hpp"
 #include "trQuadInt.hpp"
+#include <algorithm>
 #include <cmath>
 
 const tr::QuadFloat allZeroes(0.0f);
 
+#ifdef TR_SIMD
+// Masked loads and stores with SSE4.1. The AVX2 kernel uses the AVX2 instructions through the versions templated on
+// the instruction set instead.
+static __m128 maskLoad(const float* const pointer, const __m128 mask)
+{
+	const int bits = _mm_movemask_ps(mask);
+
+	if (bits == 0x0f)
+	{
+		return _mm_loadu_ps(pointer);
+	}
+
+	return _mm_setr_ps(
+		bits & 0x01 ? *(pointer + 0) : 0.0f,
+		bits & 0x02 ? *(pointer + 1) : 0.0f,
+		bits & 0x04 ? *(pointer + 2) : 0.0f,
+		bits & 0x08 ? *(pointer + 3) : 0.0f
+	);
+}
+
+static void maskStore(float* const pointer, const __m128 mask, const __m128 data)
+{
+	const int bits = _mm_movemask_ps(mask);
+
+	if (bits == 0x0f)
+	{
+		_mm_storeu_ps(pointer, data);
+
+		return;
+	}
+
+	alignas(16) float values[4];
+
+	_mm_store_ps(values, data);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (bits & (1 << i))
+		{
+			*(pointer + i) = values[i];
+		}
+	}
+}
+#endif
+
 tr::QuadFloat::QuadFloat(const float a) :
 #ifdef TR_SIMD
 	m_data(_mm_set1_ps(a))
@@ -33,7 +79,7 @@ tr::QuadFloat::QuadFloat(const float* const pointer) :
 
 tr::QuadFloat::QuadFloat(const float* const pointer, const QuadMask& mask) :
 #ifdef TR_SIMD
-	m_data(_mm_maskload_ps(pointer, _mm_castps_si128(mask.getData())))
+	m_data(maskLoad(pointer, mask.getData()))
 #else
 	m_data{ 
 		mask.get(0) ? *(pointer + 0) : 0.0f,
@@ -240,6 +286,20 @@ tr::QuadMask tr::QuadFloat::lessThan(const QuadFloat& rhs) const
 #endif
 }
 
+tr::QuadMask tr::QuadFloat::equal(const QuadFloat& rhs) const
+{
+#ifdef TR_SIMD
+	return QuadMask(_mm_cmpeq_ps(m_data, rhs.m_data));
+#else
+	return QuadMask(
+		m_data[0] == rhs.m_data[0],
+		m_data[1] == rhs.m_data[1],
+		m_data[2] == rhs.m_data[2],
+		m_data[3] == rhs.m_data[3]
+	);
+#endif
+}
+
 tr::QuadFloat tr::QuadFloat::min(const QuadFloat& rhs) const
 {
 #ifdef TR_SIMD
@@ -268,6 +328,28 @@ tr::QuadFloat tr::QuadFloat::max(const QuadFloat& rhs) const
 #endif
 }
 
+float tr::QuadFloat::horizontalMin() const
+{
+#ifdef TR_SIMD
+	const __m128 pairMin = _mm_min_ps(m_data, _mm_movehl_ps(m_data, m_data));
+
+	return _mm_cvtss_f32(_mm_min_ss(pairMin, _mm_shuffle_ps(pairMin, pairMin, _MM_SHUFFLE(1, 1, 1, 1))));
+#else
+	return std::min({ m_data[0], m_data[1], m_data[2], m_data[3] });
+#endif
+}
+
+float tr::QuadFloat::horizontalMax() const
+{
+#ifdef TR_SIMD
+	const __m128 pairMax = _mm_max_ps(m_data, _mm_movehl_ps(m_data, m_data));
+
+	return _mm_cvtss_f32(_mm_max_ss(pairMax, _mm_shuffle_ps(pairMax, pairMax, _MM_SHUFFLE(1, 1, 1, 1))));
+#else
+	return std::max({ m_data[0], m_data[1], m_data[2], m_data[3] });
+#endif
+}
+
 tr::QuadMask tr::QuadFloat::castToMask() const
 {
 #ifdef TR_SIMD
@@ -383,7 +465,7 @@ tr::QuadFloat tr::QuadFloat::maskedCopy(const QuadFloat& rhs, const QuadMask& ma
 void tr::QuadFloat::write(float* const pointer, const QuadMask& mask) const
 {
 #ifdef TR_SIMD
-	_mm_maskstore_ps(pointer, _mm_castps_si128(mask.getData()), m_data);
+	maskStore(pointer, mask.getData(), m_data);
 #else
 	for (size_t i = 0; i < m_data.size(); ++i)
 	{
@@ -393,4 +475,11 @@ void tr::QuadFloat::write(float* const pointer, const QuadMask& mask) const
 		}
 	}
 #endif
-}
\ No newline at end of file
+}
+
+#ifdef TR_SIMD
+__m128 tr::QuadFloat::getData() const
+{
+	return m_data;
+}
+#endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include "trCpu.hpp"
 #include "trQuadMask.hpp"
 #include <array>
 
@@ -33,9 +34,12 @@ namespace tr
 
 		QuadMask             greaterThan(const QuadFloat& rhs) const;
 		QuadMask             lessThan(const QuadFloat& rhs) const;
+		QuadMask             equal(const QuadFloat& rhs) const;
 
 		QuadFloat            min(const QuadFloat& rhs) const;
 		QuadFloat            max(const QuadFloat& rhs) const;
+		float                horizontalMin() const;
+		float                horizontalMax() const;
 
 		QuadMask             castToMask() const;
 
@@ -49,6 +53,18 @@ namespace tr
 
 		void                 write(float* const pointer, const QuadMask& mask) const;
 
+		// Masked loads and stores for kernels, which use the AVX2 instructions in the AVX2 kernel. The other versions
+		// emulate them with SSE4.1.
+		template <InstructionSet instructionSet>
+		static QuadFloat     load(const float* const pointer, const QuadMask& mask);
+
+		template <InstructionSet instructionSet>
+		void                 write(float* const pointer, const QuadMask& mask) const;
+
+#ifdef TR_SIMD
+		__m128               getData() const;
+#endif
+
 	private:
 #ifdef TR_SIMD
 		__m128               m_data;
@@ -56,4 +72,30 @@ namespace tr
 		std::array<float, 4> m_data;
 #endif
 	};
+
+	template <InstructionSet instructionSet>
+	inline QuadFloat QuadFloat::load(const float* const pointer, const QuadMask& mask)
+	{
+		return QuadFloat(pointer, mask);
+	}
+
+	template <InstructionSet instructionSet>
+	inline void QuadFloat::write(float* const pointer, const QuadMask& mask) const
+	{
+		write(pointer, mask);
+	}
+
+#ifdef TR_SIMD
+	template <>
+	TR_TARGET_AVX2 inline QuadFloat QuadFloat::load<InstructionSet::AVX2>(const float* const pointer, const QuadMask& mask)
+	{
+		return QuadFloat(_mm_maskload_ps(pointer, _mm_castps_si128(mask.getData())));
+	}
+
+	template <>
+	TR_TARGET_AVX2 inline void QuadFloat::write<InstructionSet::AVX2>(float* const pointer, const QuadMask& mask) const
+	{
+		_mm_maskstore_ps(pointer, _mm_castps_si128(mask.getData()), m_data);
+	}
+#endif
 }
\ No newline at end of file
@@ -1,8 +1,62 @@
 #include "trQuadInt.hpp"
 #include "trQuadFloat.hpp"
+#include <algorithm>
 
 #ifdef TR_SIMD
-const __m128i allZeroes = _mm_setzero_si128();
+// Masked loads, stores and gathers with SSE4.1. The AVX2 kernel uses the AVX2 instructions through the versions
+// templated on the instruction set instead.
+static __m128i maskLoad(const int32_t* const pointer, const __m128 mask)
+{
+	const int bits = _mm_movemask_ps(mask);
+
+	if (bits == 0x0f)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pointer));
+	}
+
+	return _mm_setr_epi32(
+		bits & 0x01 ? *(pointer + 0) : 0,
+		bits & 0x02 ? *(pointer + 1) : 0,
+		bits & 0x04 ? *(pointer + 2) : 0,
+		bits & 0x08 ? *(pointer + 3) : 0
+	);
+}
+
+static void maskStore(int32_t* const pointer, const __m128 mask, const __m128i data)
+{
+	const int bits = _mm_movemask_ps(mask);
+
+	if (bits == 0x0f)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(pointer), data);
+
+		return;
+	}
+
+	alignas(16) int32_t values[4];
+
+	_mm_store_si128(reinterpret_cast<__m128i*>(values), data);
+
+	for (int i = 0; i < 4; ++i)
+	{
+		if (bits & (1 << i))
+		{
+			*(pointer + i) = values[i];
+		}
+	}
+}
+
+static __m128i gather(const int32_t* const baseAddress, const __m128i offsets, const __m128 mask)
+{
+	const int bits = _mm_movemask_ps(mask);
+
+	return _mm_setr_epi32(
+		bits & 0x01 ? *(baseAddress + _mm_extract_epi32(offsets, 0)) : 0,
+		bits & 0x02 ? *(baseAddress + _mm_extract_epi32(offsets, 1)) : 0,
+		bits & 0x04 ? *(baseAddress + _mm_extract_epi32(offsets, 2)) : 0,
+		bits & 0x08 ? *(baseAddress + _mm_extract_epi32(offsets, 3)) : 0
+	);
+}
 #endif
 
 tr::QuadInt::QuadInt(const int32_t a) :
@@ -25,7 +79,7 @@ tr::QuadInt::QuadInt(const int32_t a, const int32_t b, const int32_t c, const in
 
 tr::QuadInt::QuadInt(const int32_t* pointer, const QuadMask& mask) :
 #ifdef TR_SIMD
-	m_data(_mm_maskload_epi32(pointer, _mm_castps_si128(mask.getData())))
+	m_data(maskLoad(pointer, mask.getData()))
 #else
 	m_data{ 
 		mask.get(0) ? *(pointer + 0) : 0,
@@ -37,6 +91,16 @@ tr::QuadInt::QuadInt(const int32_t* pointer, const QuadMask& mask) :
 {
 }
 
+// Widens four unsigned 16-bit values
+tr::QuadInt::QuadInt(const uint16_t* pointer) :
+#ifdef TR_SIMD
+	m_data(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pointer))))
+#else
+	m_data{ *(pointer + 0), *(pointer + 1), *(pointer + 2), *(pointer + 3) }
+#endif
+{
+}
+
 #ifdef TR_SIMD
 tr::QuadInt::QuadInt(const __m128i data) :
 	m_data(data)
@@ -221,6 +285,21 @@ tr::QuadMask tr::QuadInt::equal(const QuadInt& rhs) const
 #endif
 }
 
+// Lanes with the sign bit set
+tr::QuadMask tr::QuadInt::castToMask() const
+{
+#ifdef TR_SIMD
+	return QuadMask(_mm_castsi128_ps(m_data));
+#else
+	return QuadMask(
+		m_data[0] < 0,
+		m_data[1] < 0,
+		m_data[2] < 0,
+		m_data[3] < 0
+	);
+#endif
+}
+
 tr::QuadInt tr::QuadInt::maskedCopy(const QuadInt& rhs, const QuadMask& mask) const
 {
 #ifdef TR_SIMD
@@ -252,7 +331,7 @@ tr::QuadFloat tr::QuadInt::convertToQuadFloat() const
 void tr::QuadInt::write(int32_t* const address, const QuadMask& mask) const
 {
 #ifdef TR_SIMD
-	_mm_maskstore_epi32(address, _mm_castps_si128(mask.getData()), m_data);
+	maskStore(address, mask.getData(), m_data);
 #else
 	uint32_t* const intPointer = reinterpret_cast<uint32_t*>(address);
 	
@@ -266,10 +345,42 @@ void tr::QuadInt::write(int32_t* const address, const QuadMask& mask) const
 #endif
 }
 
+// Narrows to four unsigned 16-bit values, clamping those out of range
+void tr::QuadInt::writeSaturated(uint16_t* const address) const
+{
+#ifdef TR_SIMD
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(address), _mm_packus_epi32(m_data, m_data));
+#else
+	for (size_t i = 0; i < m_data.size(); ++i)
+	{
+		*(address + i) = uint16_t(std::min(std::max(m_data[i], int32_t(0)), int32_t(0xFFFF)));
+	}
+#endif
+}
+
+// Writes to a 16-byte aligned address without reading the cache line in first, for memory that won't be read again
+// soon
+void tr::QuadInt::writeStreaming(int32_t* const address) const
+{
+#ifdef TR_SIMD
+	_mm_stream_si128(reinterpret_cast<__m128i*>(address), m_data);
+#else
+	std::copy(m_data.begin(), m_data.end(), address);
+#endif
+}
+
+// Streaming writes aren't ordered with other writes, so they need this before another thread can rely on seeing them
+void tr::QuadInt::fenceStreamingWrites()
+{
+#ifdef TR_SIMD
+	_mm_sfence();
+#endif
+}
+
 tr::QuadInt tr::QuadInt::gatherIntsAtOffsets(const int32_t* const baseAddress, const QuadMask& mask) const
 {
 #ifdef TR_SIMD
-	return QuadInt(_mm_mask_i32gather_epi32(allZeroes, baseAddress, m_data, _mm_castps_si128(mask.getData()), 4));
+	return QuadInt(gather(baseAddress, m_data, mask.getData()));
 #else
 	return QuadInt(
 		mask.get(0) ? *(baseAddress + m_data[0]) : 0,
@@ -279,3 +390,10 @@ tr::QuadInt tr::QuadInt::gatherIntsAtOffsets(const int32_t* const baseAddress, c
 	);
 #endif
 }
+
+#ifdef TR_SIMD
+__m128i tr::QuadInt::getData() const
+{
+	return m_data;
+}
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 
 #include <array>
 #include <cstdint>
+#include "trCpu.hpp"
 #include "trQuadMask.hpp"
 
 namespace tr
@@ -14,6 +15,7 @@ namespace tr
 		                              QuadInt(const int32_t a);
 		                              QuadInt(const int32_t a, const int32_t b, const int32_t c, const int32_t d);
 		                              QuadInt(const int32_t* pointer, const QuadMask& mask);
+		                              QuadInt(const uint16_t* pointer);
 
 #ifdef TR_SIMD
 		                              QuadInt(const __m128i data);
@@ -36,14 +38,33 @@ namespace tr
 		QuadInt                       operator|(const QuadInt& rhs) const;
 
 		QuadMask                      equal(const QuadInt& rhs) const;
+		QuadMask                      castToMask() const;
 		QuadInt                       maskedCopy(const QuadInt& rhs, const QuadMask& mask) const;
 
 		QuadFloat                     convertToQuadFloat() const;
 
 		void                          write(int32_t* const address, const QuadMask& mask) const;
+		void                          writeSaturated(uint16_t* const address) const;
+		void                          writeStreaming(int32_t* const address) const;
+
+		static void                   fenceStreamingWrites();
+
+#ifdef TR_SIMD
+		__m128i                       getData() const;
+#endif
 
 		QuadInt                       gatherIntsAtOffsets(const int32_t* const baseAddress, const QuadMask& mask) const;
 
+		// Masked loads, stores and gathers for kernels, which use the AVX2 instructions in the AVX2 kernel. The other
+		// versions emulate them with SSE4.1.
+		template <InstructionSet instructionSet>
+		static QuadInt                load(const int32_t* const pointer, const QuadMask& mask);
+
+		template <InstructionSet instructionSet>
+		void                          write(int32_t* const address, const QuadMask& mask) const;
+
+		template <InstructionSet instructionSet>
+		QuadInt                       gatherIntsAtOffsets(const int32_t* const baseAddress, const QuadMask& mask) const;
 
 	private:
 #ifdef TR_SIMD
@@ -52,4 +73,42 @@ namespace tr
 		std::array<int32_t, 4>        m_data;
 #endif
 	};
+
+	template <InstructionSet instructionSet>
+	inline QuadInt QuadInt::load(const int32_t* const pointer, const QuadMask& mask)
+	{
+		return QuadInt(pointer, mask);
+	}
+
+	template <InstructionSet instructionSet>
+	inline void QuadInt::write(int32_t* const address, const QuadMask& mask) const
+	{
+		write(address, mask);
+	}
+
+	template <InstructionSet instructionSet>
+	inline QuadInt QuadInt::gatherIntsAtOffsets(const int32_t* const baseAddress, const QuadMask& mask) const
+	{
+		return gatherIntsAtOffsets(baseAddress, mask);
+	}
+
+#ifdef TR_SIMD
+	template <>
+	TR_TARGET_AVX2 inline QuadInt QuadInt::load<InstructionSet::AVX2>(const int32_t* const pointer, const QuadMask& mask)
+	{
+		return QuadInt(_mm_maskload_epi32(pointer, _mm_castps_si128(mask.getData())));
+	}
+
+	template <>
+	TR_TARGET_AVX2 inline void QuadInt::write<InstructionSet::AVX2>(int32_t* const address, const QuadMask& mask) const
+	{
+		_mm_maskstore_epi32(address, _mm_castps_si128(mask.getData()), m_data);
+	}
+
+	template <>
+	TR_TARGET_AVX2 inline QuadInt QuadInt::gatherIntsAtOffsets<InstructionSet::AVX2>(const int32_t* const baseAddress, const QuadMask& mask) const
+	{
+		return QuadInt(_mm_mask_i32gather_epi32(_mm_setzero_si128(), baseAddress, m_data, _mm_castps_si128(mask.getData()), 4));
+	}
+#endif
 }
\ No newline at end of file
@@ -1,20 +1,26 @@
 #include "trQuadMask.hpp"
+#include <bitset>
 
 #ifdef TR_SIMD
 // TODO: Find a better place for this
 const __m128 allOnes = _mm_castsi128_ps(_mm_set1_epi32(-1));
 #endif
 
+tr::QuadMask::QuadMask(const bool a) :
+#ifdef TR_SIMD
+	m_data(_mm_castsi128_ps(_mm_set1_epi32(a ? -1 : 0)))
+#else
+	m_data{ a, a, a, a }
+#endif
+{
+}
+
 #ifdef TR_SIMD
 tr::QuadMask::QuadMask(const __m128 data) :
 	m_data(data)
 {
 }
 #else
-tr::QuadMask::QuadMask(const bool a) :
-	m_data{ a, a, a, a }
-{
-}
 
 tr::QuadMask::QuadMask(const bool a, const bool b, const bool c, const bool d) :
 	m_data{ a, b, c, d }
@@ -97,4 +103,13 @@ bool tr::QuadMask::moveMask() const
 #else
 	return m_data[0] || m_data[1] || m_data[2] || m_data[3];
 #endif
+}
+
+size_t tr::QuadMask::count() const
+{
+#ifdef TR_SIMD
+	return std::bitset<4>(unsigned(_mm_movemask_ps(m_data))).count();
+#else
+	return size_t(m_data[0]) + size_t(m_data[1]) + size_t(m_data[2]) + size_t(m_data[3]);
+#endif
 }
\ No newline at end of file
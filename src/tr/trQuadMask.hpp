@@ -11,10 +11,10 @@ namespace tr
 	class QuadMask
 	{
 	public:
+		                    QuadMask(const bool a);
 #ifdef TR_SIMD
 		                    QuadMask(const __m128 data);
 #else
-		                    QuadMask(const bool a);
 		                    QuadMask(const bool a, const bool b, const bool c, const bool d);
 #endif
 
@@ -26,6 +26,7 @@ namespace tr
 		QuadMask            operator~() const;
 
 		bool                moveMask() const;
+		size_t              count() const;
 
 #ifdef TR_SIMD
 		__m128              getData() const;
@@ -18,6 +18,17 @@ tr::QuadTransformedVertex::QuadTransformedVertex(const QuadVec3& worldPosition,
 {
 }
 
+tr::QuadTransformedVertex& tr::QuadTransformedVertex::operator+=(const QuadTransformedVertex& rhs)
+{
+	worldPosition     += rhs.worldPosition;
+	projectedPosition += rhs.projectedPosition;
+	normal            += rhs.normal;
+	textureCoord      += rhs.textureCoord;
+	inverseW          += rhs.inverseW;
+
+	return *this;
+}
+
 tr::QuadTransformedVertex tr::QuadTransformedVertex::operator+(const QuadTransformedVertex& rhs) const
 {
 	return QuadTransformedVertex(
@@ -1,13 +1,18 @@
 #pragma once
 
 #include "trTextureMode.hpp"
+#include <limits>
 
 namespace tr
 {
 	struct RasterizationParams
 	{
-		bool        depthTest;
-		float       depthBias;
-		TextureMode textureMode;
+		// Query index of triangles that aren't counted by any occlusion query
+		static constexpr size_t s_noQuery = std::numeric_limits<size_t>::max();
+
+		bool                    depthTest;
+		float                   depthBias;
+		TextureMode             textureMode;
+		size_t                  queryIndex;
 	};
 }
\ No newline at end of file
@@ -1,11 +1,13 @@
 #pragma once
 
 #include "trAxis.hpp"
+#include "trCpu.hpp"
 #include "trTexture.hpp"
 #include "trCoord.hpp"
 #include "trCullFaceMode.hpp"
 #include "trDepthBuffer.hpp"
 #include "trEdgeInfo.hpp"
+#include "trInvalidSettingException.hpp"
 #include "trPrimitive.hpp"
 #include "trTileManager.hpp"
 #include "trTextureMode.hpp"
@@ -13,11 +15,16 @@
 #include "trVertex.hpp"
 #include "trTransformedVertex.hpp"
 #include "trVertexClipBitMasks.hpp"
+#include "trWorkerPool.hpp"
 #include "../matrix/Matrices.h"
 #include "trQuadTransformedVertex.hpp"
 #include "trRect.hpp"
 
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <thread>
+#include <vector>
 
 namespace tr
 {
@@ -25,10 +32,12 @@ namespace tr
 	class Rasterizer
 	{
 	public:
-		Rasterizer(const size_t bufferWidth, const size_t bufferHeight, const size_t tileWidth, const size_t tileHeight) :
+		// The rasterization kernels are chosen here, for the best instruction set the CPU supports unless another is
+		// given
+		Rasterizer(const size_t bufferWidth, const size_t bufferHeight, const size_t tileWidth, const size_t tileHeight, const InstructionSet instructionSet = Cpu::getSupportedInstructionSet()) :
 			m_bufferHalfWidth(float(bufferWidth) / 2.0f),
 			m_bufferHalfHeight(float(bufferHeight) / 2.0f),
-			m_tileManager(bufferWidth, bufferHeight, tileWidth, tileHeight),
+			m_tileManager(bufferWidth, bufferHeight, tileWidth, tileHeight, instructionSet),
 			m_primitive(Primitive::Triangles),
 			m_projectionMatrix(),
 			m_viewMatrix(),
@@ -37,72 +46,115 @@ namespace tr
 			m_cullFaceMode(CullFaceMode::Back),
 			m_textureMode(TextureMode::Perspective),
 			m_depthTest(true),
-			m_depthBias(0.0f)
+			m_depthBias(0.0f),
+			m_queryIndex(RasterizationParams::s_noQuery),
+			m_numQueueThreads(std::max(size_t(std::thread::hardware_concurrency()), size_t(1)))
 		{
 		}
 
-		void queue(const std::vector<Vertex>& vertices, const TShader& shader)
+		InstructionSet getInstructionSet() const
 		{
-			std::vector<TransformedVertex> transformedVertices;
+			return m_tileManager.getInstructionSet();
+		}
 
-			transformedVertices.reserve(vertices.size());
+		void queue(const std::vector<Vertex>& vertices, const TShader& shader)
+		{
+			queuePrimitives(vertices, m_tileManager.storeShader(shader));
+		}
 
-			const size_t shaderIndex              = m_tileManager.storeShader(shader);
-			const size_t rasterizationParamsIndex = m_tileManager.storeRasterizationParams(m_depthTest, m_depthBias, m_textureMode);
+		// Queues triangles that only write depth, for shadow maps and occluders. Their vertices only need positions.
+		void queue(const std::vector<Vertex>& vertices)
+		{
+			queuePrimitives(vertices, Triangle::s_noShader);
+		}
 
-			for (const Vertex& vertex : vertices)
+		// Counts the samples of the triangles queued until endQuery() that pass the depth test, or that are drawn if
+		// they have no depth test. Shaders with a late depth test are counted by the samples whose depth they change.
+		// The returned index reads the count with getQueryResult() once the frame is drawn.
+		size_t beginQuery()
+		{
+			if (m_queryIndex != RasterizationParams::s_noQuery)
 			{
-				const Vector4 worldPosition = m_modelMatrix * vertex.position;
-
-				transformedVertices.emplace_back(
-					Vector3(worldPosition.x, worldPosition.y, worldPosition.z),
-					m_projectionMatrix * m_viewMatrix * m_modelMatrix * vertex.position,
-					m_modelNormalRotationMatrix * vertex.normal,
-					vertex.textureCoord
-				);
+				throw InvalidSettingException("Queries can't be nested");
 			}
 
-			if (m_primitive == Primitive::Triangles)
-			{
-				for (std::vector<TransformedVertex>::const_iterator it = transformedVertices.begin(); it + 2 < transformedVertices.end(); it += 3)
-				{
-					clipAndQueueTriangle({ *it, *(it + 1), *(it + 2) }, shaderIndex, rasterizationParamsIndex);
-				}
-			}
-			else if (m_primitive == Primitive::TriangleStrip)
-			{
-				bool   reverse    = false;
-				size_t lastIndex  = 0;
-				size_t firstIndex = 1;
+			m_queryIndex = m_tileManager.addQuery();
 
-				for (size_t newIndex = 2; newIndex < transformedVertices.size(); ++newIndex)
-				{
-					clipAndQueueTriangle({ transformedVertices[reverse ? newIndex : lastIndex], transformedVertices[firstIndex], transformedVertices[reverse ? lastIndex : newIndex] }, shaderIndex, rasterizationParamsIndex);
+			return m_queryIndex;
+		}
 
-					firstIndex = lastIndex;
-					lastIndex  = newIndex;
-					reverse    = !reverse;
-				}
-			}
-			else if (m_primitive == Primitive::TriangleFan)
+		void endQuery()
+		{
+			if (m_queryIndex == RasterizationParams::s_noQuery)
 			{
-				for (std::vector<TransformedVertex>::const_iterator it = transformedVertices.begin() + 1; it + 1 < transformedVertices.end(); it += 1)
-				{
-					clipAndQueueTriangle({ transformedVertices.front(), *it, *(it + 1) }, shaderIndex, rasterizationParamsIndex);
-				}
+				throw InvalidSettingException("No query to end");
 			}
+
+			m_queryIndex = RasterizationParams::s_noQuery;
+		}
+
+		// Samples counted by a query of the last frame drawn, waiting for it to finish if it's still in flight
+		size_t getQueryResult(const size_t queryIndex)
+		{
+			return m_tileManager.getQueryResult(queryIndex);
 		}
 
 		void draw(const size_t numThreads, ColorBuffer& colorBuffer, DepthBuffer& depthBuffer)
 		{
+			checkQueryEnded();
+
 			m_tileManager.draw(numThreads, colorBuffer, depthBuffer);
 		}
 
+		// Draws only the depth of everything queued, including triangles queued with a shader, which isn't run
+		void drawDepth(const size_t numThreads, DepthBuffer& depthBuffer)
+		{
+			checkQueryEnded();
+
+			m_tileManager.drawDepth(numThreads, depthBuffer);
+		}
+
+		// Fixed-point depth for shadow maps and occlusion culling. Each tile is converted to float to render on, and back
+		// once it's done, so depth is tested in float, while memory only holds the smaller fixed-point depth.
+		void drawDepth(const size_t numThreads, DepthBuffer16& depthBuffer)
+		{
+			checkQueryEnded();
+
+			m_tileManager.drawDepth(numThreads, depthBuffer);
+		}
+
+		void drawDepth(const size_t numThreads, DepthBuffer24& depthBuffer)
+		{
+			checkQueryEnded();
+
+			m_tileManager.drawDepth(numThreads, depthBuffer);
+		}
+
+		FrameHandle drawAsync(const size_t numThreads, ColorBuffer& colorBuffer, DepthBuffer& depthBuffer)
+		{
+			checkQueryEnded();
+
+			return m_tileManager.drawAsync(numThreads, colorBuffer, depthBuffer);
+		}
+
 		void clear()
 		{
 			m_tileManager.clear();
 		}
 
+		// Clears the buffers of the next draw on the render threads, one tile at a time, instead of filling them whole
+		// beforehand. Tile-local buffers start from the clear values instead of loading the tile, and tiles nothing is
+		// drawn to are written without going through the cache.
+		void queueClear(const Color& color, const float depth)
+		{
+			m_tileManager.queueClear(color, depth);
+		}
+
+		void queueDepthClear(const float depth)
+		{
+			m_tileManager.queueDepthClear(depth);
+		}
+
 		void setTilerAttributes(const size_t bufferWidth, const size_t bufferHeight, const size_t tileWidth, const size_t tileHeight)
 		{
 			m_tileManager.setAttributes(bufferWidth, bufferHeight, tileWidth, tileHeight);
@@ -111,6 +163,39 @@ namespace tr
 			m_bufferHalfHeight = float(bufferHeight) / 2.0f;
 		}
 
+		void setAdaptiveTileSize(const bool adaptiveTileSize)
+		{
+			m_tileManager.setAdaptiveTileSize(adaptiveTileSize);
+		}
+
+		void setTileLocalBuffers(const bool tileLocalBuffers)
+		{
+			m_tileManager.setTileLocalBuffers(tileLocalBuffers);
+		}
+
+		void setDepthBufferWriteBack(const bool depthBufferWriteBack)
+		{
+			m_tileManager.setDepthBufferWriteBack(depthBufferWriteBack);
+		}
+
+		void setDepthPrepass(const bool depthPrepass)
+		{
+			m_tileManager.setDepthPrepass(depthPrepass);
+		}
+
+		void setVisibilityBuffer(const bool visibilityBuffer)
+		{
+			m_tileManager.setVisibilityBuffer(visibilityBuffer);
+		}
+
+		// Threads that transform, clip and set up the triangles of large meshes in queue(), one per hardware thread
+		// unless set here. While drawAsync() is in flight, the front end only takes the threads its render threads
+		// leave, since both sets of workers spin.
+		void setNumQueueThreads(const size_t numThreads)
+		{
+			m_numQueueThreads = numThreads;
+		}
+
 		void setPrimitive(const Primitive primitive)
 		{
 			m_primitive = primitive;
@@ -171,6 +256,77 @@ namespace tr
 		}
 
 	private:
+		// Queries belong to the frame they were issued in, so they can't stay open while it's drawn
+		void checkQueryEnded() const
+		{
+			if (m_queryIndex != RasterizationParams::s_noQuery)
+			{
+				throw InvalidSettingException("Queries must end before drawing");
+			}
+		}
+
+		void queuePrimitives(const std::vector<Vertex>& vertices, const size_t shaderIndex)
+		{
+			const size_t           rasterizationParamsIndex  = m_tileManager.storeRasterizationParams(m_depthTest, m_depthBias, m_textureMode, m_queryIndex);
+			const Matrix4          modelViewProjectionMatrix = m_projectionMatrix * m_viewMatrix * m_modelMatrix;
+			const size_t           numPrimitives             = getNumPrimitives(vertices.size());
+			std::vector<Triangle>& triangles                 = m_tileManager.getQueuedTriangles();
+			const size_t           firstTriangleIndex        = triangles.size();
+			const size_t           numDrawingThreads         = m_tileManager.getNumDrawingThreads();
+			const size_t           numThreads                = m_numQueueThreads > numDrawingThreads ? m_numQueueThreads - numDrawingThreads : 1;
+
+			m_transformedVertices.resize(vertices.size());
+
+			if (numThreads <= 1 || vertices.size() < s_minParallelVertices)
+			{
+				transformVertices(vertices, modelViewProjectionMatrix, 0, vertices.size());
+				assemblePrimitives(0, numPrimitives, shaderIndex, rasterizationParamsIndex, triangles);
+
+				m_tileManager.binQueuedTriangles(firstTriangleIndex);
+
+				return;
+			}
+
+			// Strips and fans share vertices across chunk boundaries, so every vertex has to be transformed before any
+			// primitives are assembled
+			const size_t        numVertexChunks    = (vertices.size() + s_verticesPerChunk - 1) / s_verticesPerChunk;
+			const size_t        numPrimitiveChunks = (numPrimitives + s_primitivesPerChunk - 1) / s_primitivesPerChunk;
+			std::atomic<size_t> nextVertexChunk(0);
+			std::atomic<size_t> nextPrimitiveChunk(0);
+
+			m_workerPool.run(numThreads, [&](const size_t)
+			{
+				size_t chunkIndex;
+
+				while ((chunkIndex = nextVertexChunk.fetch_add(1, std::memory_order_relaxed)) < numVertexChunks)
+				{
+					transformVertices(vertices, modelViewProjectionMatrix, chunkIndex * s_verticesPerChunk, std::min((chunkIndex + 1) * s_verticesPerChunk, vertices.size()));
+				}
+			});
+
+			m_primitiveChunks.resize(std::max(m_primitiveChunks.size(), numPrimitiveChunks));
+
+			m_workerPool.run(numThreads, [&](const size_t)
+			{
+				size_t chunkIndex;
+
+				while ((chunkIndex = nextPrimitiveChunk.fetch_add(1, std::memory_order_relaxed)) < numPrimitiveChunks)
+				{
+					m_primitiveChunks[chunkIndex].clear();
+
+					assemblePrimitives(chunkIndex * s_primitivesPerChunk, std::min((chunkIndex + 1) * s_primitivesPerChunk, numPrimitives), shaderIndex, rasterizationParamsIndex, m_primitiveChunks[chunkIndex]);
+				}
+			});
+
+			// Merging in chunk order keeps the triangles in submission order, whatever the number of threads
+			for (size_t chunkIndex = 0; chunkIndex < numPrimitiveChunks; ++chunkIndex)
+			{
+				triangles.insert(triangles.end(), m_primitiveChunks[chunkIndex].begin(), m_primitiveChunks[chunkIndex].end());
+			}
+
+			m_tileManager.binQueuedTriangles(firstTriangleIndex);
+		}
+
 		static TransformedVertex lineFrustumIntersection(const TransformedVertex& lineStart, const TransformedVertex& lineEnd, const tr::Axis axis, const bool negativeW)
 		{
 			const float   scalar = negativeW ?
@@ -185,7 +341,73 @@ namespace tr
 			return TransformedVertex(worldPosition, projectedPosition, normal, textureCoord);
 		}
 
-		void queueTriangle(std::array<TransformedVertex, 3>&& vertices, const size_t shaderIndex, const size_t rasterizationParamsIndex)
+		size_t getNumPrimitives(const size_t numVertices) const
+		{
+			if (m_primitive == Primitive::Triangles)
+			{
+				return numVertices / 3;
+			}
+			else
+			{
+				return numVertices > 2 ? numVertices - 2 : 0;
+			}
+		}
+
+		void transformVertices(const std::vector<Vertex>& vertices, const Matrix4& modelViewProjectionMatrix, const size_t begin, const size_t end)
+		{
+			for (size_t vertexIndex = begin; vertexIndex < end; ++vertexIndex)
+			{
+				const Vertex& vertex        = vertices[vertexIndex];
+				const Vector4 worldPosition = m_modelMatrix * vertex.position;
+
+				m_transformedVertices[vertexIndex] = TransformedVertex(
+					Vector3(worldPosition.x, worldPosition.y, worldPosition.z),
+					modelViewProjectionMatrix * vertex.position,
+					m_modelNormalRotationMatrix * vertex.normal,
+					vertex.textureCoord
+				);
+			}
+		}
+
+		void assemblePrimitives(const size_t begin, const size_t end, const size_t shaderIndex, const size_t rasterizationParamsIndex, std::vector<Triangle>& triangles) const
+		{
+			const std::vector<TransformedVertex>& transformedVertices = m_transformedVertices;
+
+			if (m_primitive == Primitive::Triangles)
+			{
+				for (size_t primitiveIndex = begin; primitiveIndex < end; ++primitiveIndex)
+				{
+					const size_t firstIndex = primitiveIndex * 3;
+
+					clipAndQueueTriangle({ transformedVertices[firstIndex], transformedVertices[firstIndex + 1], transformedVertices[firstIndex + 2] }, shaderIndex, rasterizationParamsIndex, triangles);
+				}
+			}
+			else if (m_primitive == Primitive::TriangleStrip)
+			{
+				// Start from the state the loop would be in if it had run from the beginning of the strip
+				bool   reverse    = begin % 2 == 1;
+				size_t lastIndex  = begin == 0 ? 0 : begin + 1;
+				size_t firstIndex = begin == 0 ? 1 : (begin == 1 ? 0 : begin);
+
+				for (size_t newIndex = begin + 2; newIndex < end + 2; ++newIndex)
+				{
+					clipAndQueueTriangle({ transformedVertices[reverse ? newIndex : lastIndex], transformedVertices[firstIndex], transformedVertices[reverse ? lastIndex : newIndex] }, shaderIndex, rasterizationParamsIndex, triangles);
+
+					firstIndex = lastIndex;
+					lastIndex  = newIndex;
+					reverse    = !reverse;
+				}
+			}
+			else if (m_primitive == Primitive::TriangleFan)
+			{
+				for (size_t primitiveIndex = begin; primitiveIndex < end; ++primitiveIndex)
+				{
+					clipAndQueueTriangle({ transformedVertices.front(), transformedVertices[primitiveIndex + 1], transformedVertices[primitiveIndex + 2] }, shaderIndex, rasterizationParamsIndex, triangles);
+				}
+			}
+		}
+
+		void queueTriangle(std::array<TransformedVertex, 3>&& vertices, const size_t shaderIndex, const size_t rasterizationParamsIndex, std::vector<Triangle>& triangles) const
 		{
 			perspectiveDivide(vertices);
 
@@ -203,10 +425,18 @@ namespace tr
 			viewportTransformation(vertices);
 			pixelShift(vertices);
 
-			m_tileManager.queue(Triangle(std::move(vertices), shaderIndex, rasterizationParamsIndex));
+			std::array<EdgeFunction, 3> edges;
+
+			// Triangles that snap to zero area can't cover any pixels
+			if (!EdgeFunction::setup(vertices, edges))
+			{
+				return;
+			}
+
+			triangles.emplace_back(vertices, edges, shaderIndex, rasterizationParamsIndex);
 		}
 
-		void clipAndQueueTriangle(std::array<TransformedVertex, 3>&& vertices, const size_t shaderIndex, const size_t rasterizationParamsIndex)
+		void clipAndQueueTriangle(std::array<TransformedVertex, 3>&& vertices, const size_t shaderIndex, const size_t rasterizationParamsIndex, std::vector<Triangle>& triangles) const
 		{
 			if (vertices[0].worldPosition == vertices[1].worldPosition || vertices[1].worldPosition == vertices[2].worldPosition || vertices[2].worldPosition == vertices[0].worldPosition)
 			{
@@ -242,7 +472,7 @@ namespace tr
 
 			if (!(vertexClipBitFields[0] | vertexClipBitFields[1] | vertexClipBitFields[2]))
 			{
-				queueTriangle(std::move(vertices), shaderIndex, rasterizationParamsIndex);
+				queueTriangle(std::move(vertices), shaderIndex, rasterizationParamsIndex, triangles);
 			}
 			else if ((vertexClipBitFields[0] | vertexEqualityBitFields[0]) &
 					 (vertexClipBitFields[1] | vertexEqualityBitFields[1]) &
@@ -276,8 +506,8 @@ namespace tr
 							assert(false);
 						}
 
-						clipAndQueueTriangle({ firstVertex,  intersection,   oppositeVertex }, shaderIndex, rasterizationParamsIndex);
-						clipAndQueueTriangle({ secondVertex, oppositeVertex, intersection   }, shaderIndex, rasterizationParamsIndex);
+						clipAndQueueTriangle({ firstVertex,  intersection,   oppositeVertex }, shaderIndex, rasterizationParamsIndex, triangles);
+						clipAndQueueTriangle({ secondVertex, oppositeVertex, intersection   }, shaderIndex, rasterizationParamsIndex, triangles);
 
 						break;
 					}
@@ -327,17 +557,26 @@ namespace tr
 		}
 
 	private:
-		float                 m_bufferHalfWidth;
-		float                 m_bufferHalfHeight;
-		TileManager<TShader>  m_tileManager;
-		Primitive             m_primitive;
-		Matrix4               m_projectionMatrix;
-		Matrix4               m_viewMatrix;
-		Matrix4               m_modelMatrix;
-		Matrix3               m_modelNormalRotationMatrix;
-		CullFaceMode          m_cullFaceMode;
-		TextureMode           m_textureMode;
-		bool                  m_depthTest;
-		float                 m_depthBias;
+		static constexpr size_t            s_minParallelVertices = 16384;
+		static constexpr size_t            s_verticesPerChunk    = 4096;
+		static constexpr size_t            s_primitivesPerChunk  = 2048;
+
+		float                              m_bufferHalfWidth;
+		float                              m_bufferHalfHeight;
+		TileManager<TShader>               m_tileManager;
+		Primitive                          m_primitive;
+		Matrix4                            m_projectionMatrix;
+		Matrix4                            m_viewMatrix;
+		Matrix4                            m_modelMatrix;
+		Matrix3                            m_modelNormalRotationMatrix;
+		CullFaceMode                       m_cullFaceMode;
+		TextureMode                        m_textureMode;
+		bool                               m_depthTest;
+		float                              m_depthBias;
+		size_t                             m_queryIndex;
+		size_t                             m_numQueueThreads;
+		WorkerPool                         m_workerPool;
+		std::vector<TransformedVertex>     m_transformedVertices;
+		std::vector<std::vector<Triangle>> m_primitiveChunks;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+namespace tr
+{
+	enum class RenderPass
+	{
+		Color,
+		Depth,
+		ColorEqualDepth,
+		Visibility
+	};
+}
\ No newline at end of file
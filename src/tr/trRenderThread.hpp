@@ -1,209 +1,894 @@
 #pragma once
 
-#include <condition_variable>
-#include <thread>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
 #include "trColorBuffer.hpp"
+#include "trCoverage.hpp"
 #include "trDepthBuffer.hpp"
+#include "trEdgeFunction.hpp"
+#include "trFixedPointDepth.hpp"
+#include "trHierarchicalDepth.hpp"
+#include "trKernelTarget.hpp"
+#include "trOctFloat.hpp"
+#include "trOctInt.hpp"
+#include "trFrameContext.hpp"
+#include "trRenderThreadBase.hpp"
 #include "trTile.hpp"
+#include "trTileBuffer.hpp"
+#include "trTileScheduler.hpp"
 #include "trTriangle.hpp"
 #include "trRasterizationParams.hpp"
+#include "trRenderPass.hpp"
+#include "trShaderTraits.hpp"
 
 namespace tr
 {
-	template <typename TShader>
-	class RenderThread
+	// Compiled once for each kernel instruction set, which only changes the eight-lane types rasterization uses
+	template <typename TShader, InstructionSet instructionSet>
+	class RenderThread : public RenderThreadBase<TShader>
 	{
+	private:
+		typedef tr::OctFloat<instructionSet> OctFloat;
+		typedef tr::OctInt<instructionSet>   OctInt;
+		typedef tr::OctMask<instructionSet>  OctMask;
+
 	public:
-		RenderThread(const std::vector<Tile>& tiles, const std::vector<Triangle>& triangles, const std::vector<TShader>& shaders, const std::vector<RasterizationParams>& rasterizationParams) :
-			m_quit(false),
-			m_draw(false),
-			m_tiles(tiles),
-			m_triangles(triangles),
-			m_shaders(shaders),
-			m_rasterizationParams(rasterizationParams),
-			m_nextTileIndex(nullptr),
+		RenderThread(const size_t threadIndex) :
+			m_threadIndex(threadIndex),
+			m_frame(nullptr),
+			m_tileScheduler(nullptr),
 			m_colorBuffer(nullptr),
 			m_depthBuffer(nullptr),
-			m_continueConditionVariable(),
-			m_waitConditionVariable(),
-			m_mutex(),
-			m_thread(&RenderThread::threadFunction, this)
+			m_depthBuffer16(nullptr),
+			m_depthBuffer24(nullptr),
+			m_colorData(nullptr),
+			m_depthData(nullptr),
+			m_stride(0),
+			m_originX(0),
+			m_originY(0),
+			m_queryResult(nullptr),
+			m_triangleId(s_noTriangle)
 		{
 		}
-		
-		~RenderThread()
+
+		void draw(const FrameContext<TShader>& frame, TileScheduler& tileScheduler, tr::ColorBuffer* colorBuffer, tr::DepthBuffer& depthBuffer) override
 		{
-			kill();
+			m_colorBuffer   = colorBuffer;
+			m_depthBuffer   = &depthBuffer;
+			m_depthBuffer16 = nullptr;
+			m_depthBuffer24 = nullptr;
+
+			render(frame, tileScheduler);
 		}
 
-		void draw(std::atomic<size_t>& nextTileIndex, tr::ColorBuffer& colorBuffer, tr::DepthBuffer& depthBuffer)
+		void draw(const FrameContext<TShader>& frame, TileScheduler& tileScheduler, tr::DepthBuffer16& depthBuffer) override
 		{
-			std::unique_lock<std::mutex> lock(m_mutex);
-
-			m_nextTileIndex = &nextTileIndex;
-			m_colorBuffer   = &colorBuffer;
-			m_depthBuffer   = &depthBuffer;
+			m_colorBuffer   = nullptr;
+			m_depthBuffer   = nullptr;
+			m_depthBuffer16 = &depthBuffer;
+			m_depthBuffer24 = nullptr;
 
-			m_draw = true;
+			render(frame, tileScheduler);
+		}
 
-			lock.unlock();
+		void draw(const FrameContext<TShader>& frame, TileScheduler& tileScheduler, tr::DepthBuffer24& depthBuffer) override
+		{
+			m_colorBuffer   = nullptr;
+			m_depthBuffer   = nullptr;
+			m_depthBuffer16 = nullptr;
+			m_depthBuffer24 = &depthBuffer;
 
-			m_continueConditionVariable.notify_one();
+			render(frame, tileScheduler);
 		}
 
-		void wait()
+		size_t getQueryResult(const size_t queryIndex) const override
 		{
-			std::unique_lock<std::mutex> lock(m_mutex);
-			m_waitConditionVariable.wait(lock, [&]{ return !m_draw; });
+			return m_queryResults[queryIndex];
 		}
 
-		void kill()
+	private:
+		void render(const FrameContext<TShader>& frame, TileScheduler& tileScheduler)
 		{
-			std::unique_lock<std::mutex> lock(m_mutex);
-			m_quit = true;
-			lock.unlock();
-			m_continueConditionVariable.notify_one();
+			m_frame         = &frame;
+			m_tileScheduler = &tileScheduler;
+
+			m_queryResults.assign(frame.numQueries, 0);
+
+			// Depth-only draws have no color buffer, and write float depth straight to the depth buffer. Fixed-point
+			// depth is converted to float in a tile-local buffer for each tile instead, so the rasterizer only ever
+			// works on float depth. The visibility buffer is laid out like a tile-local buffer, so it always renders
+			// with them.
+			const bool   fixedPointDepth  = m_depthBuffer16 || m_depthBuffer24;
+			const bool   tileLocalBuffers = fixedPointDepth || ((m_frame->tileLocalBuffers || m_frame->visibilityBuffer) && !m_frame->depthOnly);
 
-			if (m_thread.joinable())
+			// Fixed-point depth is cleared to the depth its clear value converts back to, so pixels that aren't drawn
+			// over are tested the same in every tile
+			PendingClear pendingClear     = m_frame->pendingClear;
+			uint16_t     clearDepth16     = 0;
+			Depth24      clearDepth24     = {};
+
+			if (m_depthBuffer16)
 			{
-				m_thread.join();
+				FixedPointDepth::encode(&pendingClear.depth, &clearDepth16, 1);
+				FixedPointDepth::decode(&clearDepth16, &pendingClear.depth, 1);
+			}
+			else if (m_depthBuffer24)
+			{
+				FixedPointDepth::encode(&pendingClear.depth, &clearDepth24, 1);
+				FixedPointDepth::decode(&clearDepth24, &pendingClear.depth, 1);
 			}
-		}
 
-	private:
-		void threadFunction()
-		{
-			while (!m_quit)
+			// Tile-local depth that isn't written back isn't cleared in the depth buffer either
+			const bool   writesDepthClear = pendingClear.clearDepth && (fixedPointDepth || !tileLocalBuffers || m_frame->depthBufferWriteBack);
+
+			size_t       myTileIndex;
+
+			while (m_tileScheduler->getNextTile(m_threadIndex, myTileIndex))
 			{
-				std::unique_lock<std::mutex> lock(m_mutex);
-				m_continueConditionVariable.wait(lock, [&]{ return m_draw || m_quit; });
+				const Tile& tile = m_frame->tiles[myTileIndex];
 
-				if (m_draw)
+				// Tiles without triangles only need their clears, which are written straight to memory since nothing
+				// reads them before the frame is done
+				if (tile.getTriangleIndices().empty())
 				{
-					render();
+					if (pendingClear.clearColor && m_colorBuffer)
+					{
+						m_colorBuffer->fillStreaming(tile.getBounds(), pendingClear.color);
+					}
+
+					if (writesDepthClear && m_depthBuffer16)
+					{
+						m_depthBuffer16->fillStreaming(tile.getBounds(), clearDepth16);
+					}
+					else if (writesDepthClear && m_depthBuffer24)
+					{
+						// Three-byte depth doesn't tile the quads that streaming writes take
+						m_depthBuffer24->fill(tile.getBounds(), clearDepth24);
+					}
+					else if (writesDepthClear)
+					{
+						m_depthBuffer->fillStreaming(tile.getBounds(), pendingClear.depth);
+					}
 
-					m_draw = false;
+					continue;
+				}
+
+				if (tileLocalBuffers)
+				{
+					if (m_depthBuffer16)
+					{
+						m_tileBuffer.load(*m_depthBuffer16, tile.getBounds(), pendingClear);
+					}
+					else if (m_depthBuffer24)
+					{
+						m_tileBuffer.load(*m_depthBuffer24, tile.getBounds(), pendingClear);
+					}
+					else
+					{
+						m_tileBuffer.load(*m_colorBuffer, *m_depthBuffer, tile.getBounds(), pendingClear);
+					}
 
-					lock.unlock();
-					m_waitConditionVariable.notify_one();
+					m_colorData = m_tileBuffer.getColorData();
+					m_depthData = m_tileBuffer.getDepthData();
+					m_stride    = m_tileBuffer.getStride();
+					m_originX   = tile.getBounds().getMinX();
+					m_originY   = tile.getBounds().getMinY();
+				}
+				else
+				{
+					m_colorData = m_colorBuffer ? m_colorBuffer->getData() : nullptr;
+					m_depthData = m_depthBuffer->getData();
+					m_stride    = m_depthBuffer->getWidth();
+					m_originX   = 0;
+					m_originY   = 0;
+
+					// The tile is about to be rendered, so it might as well be cleared through the cache
+					if (pendingClear.clearColor && m_colorBuffer)
+					{
+						m_colorBuffer->fill(tile.getBounds(), pendingClear.color);
+					}
+
+					if (pendingClear.clearDepth)
+					{
+						m_depthBuffer->fill(tile.getBounds(), pendingClear.depth);
+					}
+				}
+
+				const float* tileDepthData = m_depthData + (tile.getBounds().getMinY() - m_originY) * m_stride + tile.getBounds().getMinX() - m_originX;
+
+				if (pendingClear.clearDepth)
+				{
+					m_hierarchicalDepth.reset(tileDepthData, m_stride, tile.getBounds(), pendingClear.depth);
+				}
+				else
+				{
+					m_hierarchicalDepth.reset(tileDepthData, m_stride, tile.getBounds());
+				}
+
+				if (m_frame->depthOnly)
+				{
+					renderTriangles<RenderPass::Depth>(tile, false);
+				}
+				else if (m_frame->visibilityBuffer)
+				{
+					m_triangleIds.assign(m_stride * (tile.getBounds().getMaxY() - tile.getBounds().getMinY() + 1), int32_t(s_noTriangle));
+
+					renderTriangles<RenderPass::Visibility>(tile, false);
+					shadeVisibleTriangles(tile);
+
+					// Shaders that test depth themselves can't be resolved by the visibility pass, so they're drawn
+					// forward over the shaded pixels
+					if (ShaderTraits<TShader>::s_lateDepthTest)
+					{
+						renderTriangles<RenderPass::Color>(tile, true);
+					}
+				}
+				else if (m_frame->depthPrepass)
+				{
+					renderTriangles<RenderPass::Depth>(tile, false);
+					renderTriangles<RenderPass::ColorEqualDepth>(tile, true);
+				}
+				else
+				{
+					renderTriangles<RenderPass::Color>(tile, false);
+				}
+
+				if (m_depthBuffer16)
+				{
+					m_tileBuffer.store(*m_depthBuffer16);
+				}
+				else if (m_depthBuffer24)
+				{
+					m_tileBuffer.store(*m_depthBuffer24);
+				}
+				else if (tileLocalBuffers)
+				{
+					m_tileBuffer.store(*m_colorBuffer, *m_depthBuffer, m_frame->depthBufferWriteBack);
 				}
 			}
 		}
 
-		void render() const
+		template <RenderPass pass>
+		void renderTriangles(const Tile& tile, const bool depthOnlyDrawn)
+		{
+			KernelTarget<instructionSet>::run([&]
+			{
+				for (const size_t triangleIndex : tile.getTriangleIndices())
+				{
+					const Triangle& triangle = m_frame->triangles[triangleIndex];
+
+					// Depth-only triangles are drawn in the first pass over the tile. The visibility pass draws them itself,
+					// so they hide the triangles behind them from shading.
+					if (isDepthOnly(triangle) && pass != RenderPass::Visibility)
+					{
+						if (!depthOnlyDrawn)
+						{
+							renderTriangle<RenderPass::Depth>(triangleIndex, tile);
+						}
+					}
+					else
+					{
+						renderTriangle<pass>(triangleIndex, tile);
+					}
+				}
+			});
+		}
+
+		// Triangles queued without a shader, and every triangle in a depth-only draw, only write depth
+		bool isDepthOnly(const Triangle& triangle) const
+		{
+			return m_frame->depthOnly || triangle.shaderIndex == Triangle::s_noShader;
+		}
+
+		template <RenderPass pass>
+		void renderTriangle(const size_t triangleIndex, const Tile& tile)
 		{
-			size_t myTileIndex;
+			const Triangle& triangle    = m_frame->triangles[triangleIndex];
+			const Rect      boundingBox = triangle.boundingBox.intersection(tile.getBounds());
 
-			while ((myTileIndex  = m_nextTileIndex->fetch_add(1, std::memory_order_relaxed)) < m_tiles.size())
+			if (!boundingBox.isValid())
 			{
-				const Tile& tile = m_tiles[myTileIndex];
+				return;
+			}
 
-				for (const Triangle& triangle : m_triangles)
-				{
-					const Rect boundingBox = triangle.boundingBox.intersection(tile.getBounds());
+			const TShader*             shader              = pass == RenderPass::Depth || pass == RenderPass::Visibility ? nullptr : &m_frame->shaders[triangle.shaderIndex];
+			const RasterizationParams& rasterizationParams = m_frame->rasterizationParams[triangle.rasterizationParamsIndex];
+
+			// Shaded triangles with a late depth test can't take part in the pre-pass, so they're only drawn in the color
+			// pass. Those without any depth test write their depth in it like depth-only ones, in submission order.
+			if (pass == RenderPass::Depth && ShaderTraits<TShader>::s_lateDepthTest && !isDepthOnly(triangle))
+			{
+				return;
+			}
+
+			// Nor can late depth tests be resolved by the visibility pass
+			if (pass == RenderPass::Visibility && ShaderTraits<TShader>::s_lateDepthTest && !isDepthOnly(triangle))
+			{
+				return;
+			}
+
+			// The color pass after a pre-pass matches depths exactly, so the bias no longer applies
+			const float                minDepth            = triangle.minDepth + (pass == RenderPass::ColorEqualDepth ? 0.0f : rasterizationParams.depthBias);
+
+			if (testsDepthEarly<pass>(rasterizationParams) && m_hierarchicalDepth.isOccluded(boundingBox, minDepth, pass == RenderPass::ColorEqualDepth))
+			{
+				return;
+			}
+
+			// Samples are counted in the pass that decides whether they're visible, which for shaded triangles in a
+			// pre-pass draw is the color pass
+			const bool                 counted             = rasterizationParams.queryIndex != RasterizationParams::s_noQuery && (pass != RenderPass::Depth || isDepthOnly(triangle));
+
+			m_queryResult = counted ? &m_queryResults[rasterizationParams.queryIndex] : nullptr;
+			m_triangleId  = isDepthOnly(triangle) ? s_noTriangle : int32_t(triangleIndex);
+
+			if (triangle.small)
+			{
+				renderSmallTriangle<pass>(triangle, boundingBox, shader, rasterizationParams, minDepth);
+
+				return;
+			}
+
+			const std::array<EdgeFunction, 3>& edges    = triangle.edges;
+			const Coverage                     coverage = classifyBoundingBox(edges, boundingBox, tile.getBounds());
+
+			if (coverage == Coverage::None)
+			{
+				return;
+			}
+
+			const AttributePlanes&      attributePlanes    = triangle.attributePlanes;
+			const QuadTransformedVertex attributeGradientX(attributePlanes.gradientX);
+			const QuadFloat             depthGradientX(attributePlanes.gradientX.projectedPosition.z);
+			const QuadFloat             depthGradientY(attributePlanes.gradientY.projectedPosition.z);
+			const OctFloat              depthStepX(attributePlanes.gradientX.projectedPosition.z * 8.0f);
+
+			Color*         rowColorPointer = m_colorData + (boundingBox.getMinY() - m_originY) * m_stride + boundingBox.getMinX() - m_originX;
+			float*         rowDepthPointer = m_depthData + (boundingBox.getMinY() - m_originY) * m_stride + boundingBox.getMinX() - m_originX;
+
+			const QuadFloat lowOffsetsX  = QuadFloat(float(boundingBox.getMinX()),     float(boundingBox.getMinX() + 1), float(boundingBox.getMinX() + 2), float(boundingBox.getMinX() + 3)) - attributePlanes.origin.projectedPosition.x;
+			const QuadFloat highOffsetsX = QuadFloat(float(boundingBox.getMinX() + 4), float(boundingBox.getMinX() + 5), float(boundingBox.getMinX() + 6), float(boundingBox.getMinX() + 7)) - attributePlanes.origin.projectedPosition.x;
+
+			const OctMask  allLanesMask(true);
+			const OctMask  lowLanesMask(QuadMask(true), QuadMask(false));
+
+			// The edge functions are stepped exactly in 64 bits once per eight pixels, and the lanes are offset from
+			// that in 32 bits
+			const OctInt   laneEdgeSteps0 = getLaneEdgeSteps(edges[0]);
+			const OctInt   laneEdgeSteps1 = getLaneEdgeSteps(edges[1]);
+			const OctInt   laneEdgeSteps2 = getLaneEdgeSteps(edges[2]);
+
+			int64_t        rowEdgeValue0  = edges[0].evaluate(boundingBox.getMinX(), boundingBox.getMinY());
+			int64_t        rowEdgeValue1  = edges[1].evaluate(boundingBox.getMinX(), boundingBox.getMinY());
+			int64_t        rowEdgeValue2  = edges[2].evaluate(boundingBox.getMinX(), boundingBox.getMinY());
 
-					if (!boundingBox.isValid())
+			for (size_t y = boundingBox.getMinY(); y <= boundingBox.getMaxY(); y += 1, rowColorPointer += m_stride, rowDepthPointer += m_stride, rowEdgeValue0 += edges[0].stepY, rowEdgeValue1 += edges[1].stepY, rowEdgeValue2 += edges[2].stepY)
+			{
+				int64_t rowMinOffset = 0;
+				int64_t rowMaxOffset = int64_t(boundingBox.getMaxX() - boundingBox.getMinX());
+
+				// Only the span of the row between the edges is traversed, starting from the group of eight pixels
+				// that contains its first pixel
+				if (coverage == Coverage::Partial)
+				{
+					if (!clipRowToEdge(rowEdgeValue0, edges[0].stepX, rowMinOffset, rowMaxOffset) ||
+					    !clipRowToEdge(rowEdgeValue1, edges[1].stepX, rowMinOffset, rowMaxOffset) ||
+					    !clipRowToEdge(rowEdgeValue2, edges[2].stepX, rowMinOffset, rowMaxOffset))
 					{
 						continue;
 					}
 
-					const TShader&             shader              = m_shaders[triangle.shaderIndex];
-					const RasterizationParams& rasterizationParams = m_rasterizationParams[triangle.rasterizationParamsIndex];
+					rowMinOffset &= ~int64_t(7);
+				}
+
+				// Only depth is stepped along the row, since every group needs it for the depth test. The other
+				// attributes are evaluated from the start of the row for the quads that pass.
+				const QuadFloat       offsetX        = float(rowMinOffset);
+				const QuadFloat       offsetY        = float(y) - attributePlanes.origin.projectedPosition.y;
+				const QuadFloat       rowDepth       = QuadFloat(attributePlanes.origin.projectedPosition.z) + depthGradientY * offsetY;
 
-					const QuadFloat             quadA01(4.0f * (triangle.vertices[0].projectedPosition.y - triangle.vertices[1].projectedPosition.y));
-					const QuadFloat             quadB01(1.0f * (triangle.vertices[1].projectedPosition.x - triangle.vertices[0].projectedPosition.x));
-					const QuadFloat             quadA12(4.0f * (triangle.vertices[1].projectedPosition.y - triangle.vertices[2].projectedPosition.y));
-					const QuadFloat             quadB12(1.0f * (triangle.vertices[2].projectedPosition.x - triangle.vertices[1].projectedPosition.x));
-					const QuadFloat             quadA20(4.0f * (triangle.vertices[2].projectedPosition.y - triangle.vertices[0].projectedPosition.y));
-					const QuadFloat             quadB20(1.0f * (triangle.vertices[0].projectedPosition.x - triangle.vertices[2].projectedPosition.x));
-					const QuadTransformedVertex quadVertex0(triangle.vertices[0]);
-					const QuadTransformedVertex quadVertex1(triangle.vertices[1]);
-					const QuadTransformedVertex quadVertex2(triangle.vertices[2]);
-					const QuadFloat             quadArea(orientPoints(quadVertex0.projectedPosition, quadVertex1.projectedPosition, quadVertex2.projectedPosition));
+				const QuadTransformedVertex rowAttributes = getRowAttributes<pass>(attributePlanes, offsetY);
 
-					const size_t   bufferStepX  = 4;
-					const size_t   bufferStepY  = m_depthBuffer->getWidth() - (boundingBox.getMaxX() - boundingBox.getMinX()) + (boundingBox.getMaxX() - boundingBox.getMinX()) % bufferStepX - bufferStepX;
+				QuadFloat             groupOffsetsX  = lowOffsetsX + offsetX;
+				OctFloat              depth          = OctFloat(rowDepth + depthGradientX * groupOffsetsX, rowDepth + depthGradientX * (highOffsetsX + offsetX));
 
-					Color*         colorPointer = m_colorBuffer->getData() + boundingBox.getMinY() * m_colorBuffer->getWidth() + boundingBox.getMinX();
-					float*         depthPointer = m_depthBuffer->getData() + boundingBox.getMinY() * m_depthBuffer->getWidth() + boundingBox.getMinX();
+				int64_t               edgeValue0     = rowEdgeValue0 + rowMinOffset * edges[0].stepX;
+				int64_t               edgeValue1     = rowEdgeValue1 + rowMinOffset * edges[1].stepX;
+				int64_t               edgeValue2     = rowEdgeValue2 + rowMinOffset * edges[2].stepX;
 
-					const QuadVec3 points(
-						QuadFloat(float(boundingBox.getMinX()), float(boundingBox.getMinX() + 1), float(boundingBox.getMinX() + 2), float(boundingBox.getMinX() + 3)),
-						QuadFloat(float(boundingBox.getMinY()), float(boundingBox.getMinY()    ), float(boundingBox.getMinY()    ), float(boundingBox.getMinY()    )),
-						0.0f
-					);
-					
-					QuadFloat rowWeights0 = orientPoints(quadVertex1.projectedPosition, quadVertex2.projectedPosition, points);
-					QuadFloat rowWeights1 = orientPoints(quadVertex2.projectedPosition, quadVertex0.projectedPosition, points);
-					QuadFloat rowWeights2 = orientPoints(quadVertex0.projectedPosition, quadVertex1.projectedPosition, points);
+				Color*                colorPointer   = rowColorPointer + rowMinOffset;
+				float*                depthPointer   = rowDepthPointer + rowMinOffset;
 
-					for (size_t y = boundingBox.getMinY(); y <= boundingBox.getMaxY(); y += 1, colorPointer += bufferStepY, depthPointer += bufferStepY)
+				const size_t          rowMaxX        = boundingBox.getMinX() + size_t(rowMaxOffset);
+
+				for (size_t x = boundingBox.getMinX() + size_t(rowMinOffset); x <= rowMaxX; x += 8, colorPointer += 8, depthPointer += 8)
+				{
+					// The bounding box is only aligned to quads, so the second one can be past its end
+					const bool   hasHighQuad     = x + 4 <= boundingBox.getMaxX();
+					const size_t lowBlockIndex   = m_hierarchicalDepth.getBlockIndex(x, y);
+					const size_t highBlockIndex  = hasHighQuad ? m_hierarchicalDepth.getBlockIndex(x + 4, y) : lowBlockIndex;
+
+					OctMask      renderMask      = hasHighQuad ? allLanesMask : lowLanesMask;
+
+					if (coverage == Coverage::Partial)
 					{
-						QuadFloat weights0 = rowWeights0;
-						QuadFloat weights1 = rowWeights1;
-						QuadFloat weights2 = rowWeights2;
+						const OctInt laneEdgeValues0 = OctInt(clampEdgeValue(edgeValue0)) + laneEdgeSteps0;
+						const OctInt laneEdgeValues1 = OctInt(clampEdgeValue(edgeValue1)) + laneEdgeSteps1;
+						const OctInt laneEdgeValues2 = OctInt(clampEdgeValue(edgeValue2)) + laneEdgeSteps2;
 
-						for (size_t x = boundingBox.getMinX(); x <= boundingBox.getMaxX(); x += 4, colorPointer += bufferStepX, depthPointer += bufferStepX)
-						{
-							const QuadMask positiveWeightsMask = ~(weights0 | weights1 | weights2).castToMask();
-							const QuadMask negativeWeightsMask =  (weights0 & weights1 & weights2).castToMask();
+						renderMask &= ~(laneEdgeValues0 | laneEdgeValues1 | laneEdgeValues2).castToMask();
+					}
+
+					if (testsDepthEarly<pass>(rasterizationParams))
+					{
+						renderMask &= getUnoccludedMask<pass>(lowBlockIndex, highBlockIndex, minDepth);
+					}
+
+					if (renderMask.moveMask())
+					{
+						renderGroup<pass>(shader, rasterizationParams, renderMask, depth, rowAttributes, attributeGradientX, groupOffsetsX, attributePlanes, x, y, colorPointer, depthPointer);
+					}
+
+					groupOffsetsX  += 8.0f;
+					depth          += depthStepX;
+
+					edgeValue0     += 8 * edges[0].stepX;
+					edgeValue1     += 8 * edges[1].stepX;
+					edgeValue2     += 8 * edges[2].stepX;
+				}
+			}
+		}
+
+		// Triangles that fit in a single group of eight pixels per row skip the bounding box classification, row
+		// clipping and attribute stepping, and only evaluate their attributes in rows that have coverage
+		template <RenderPass pass>
+		void renderSmallTriangle(const Triangle& triangle, const Rect& boundingBox, const TShader* shader, const RasterizationParams& rasterizationParams, const float minDepth)
+		{
+			const std::array<EdgeFunction, 3>& edges              = triangle.edges;
+			const AttributePlanes&             attributePlanes    = triangle.attributePlanes;
+			const QuadTransformedVertex        attributeGradientX(attributePlanes.gradientX);
 
-							QuadMask       renderMask          = positiveWeightsMask | negativeWeightsMask;
+			const size_t   minX           = boundingBox.getMinX();
+			const bool     hasHighQuad    = minX + 4 <= boundingBox.getMaxX();
 
-							if (renderMask.moveMask())
-							{
-								const QuadFloat       normalizedWeights0 = (weights0 / quadArea).abs();
-								const QuadFloat       normalizedWeights1 = (weights1 / quadArea).abs();
-								const QuadFloat       normalizedWeights2 = (weights2 / quadArea).abs();
+			const OctMask  laneMask       = hasHighQuad ? OctMask(true) : OctMask(QuadMask(true), QuadMask(false));
+			const OctInt   laneEdgeSteps0 = getLaneEdgeSteps(edges[0]);
+			const OctInt   laneEdgeSteps1 = getLaneEdgeSteps(edges[1]);
+			const OctInt   laneEdgeSteps2 = getLaneEdgeSteps(edges[2]);
 
-								QuadTransformedVertex attributes         = quadVertex0 * normalizedWeights0 + quadVertex1 * normalizedWeights1 + quadVertex2 * normalizedWeights2;
+			int64_t        edgeValue0     = edges[0].evaluate(minX, boundingBox.getMinY());
+			int64_t        edgeValue1     = edges[1].evaluate(minX, boundingBox.getMinY());
+			int64_t        edgeValue2     = edges[2].evaluate(minX, boundingBox.getMinY());
 
-								if (rasterizationParams.depthTest)
-								{
-									renderMask &= QuadFloat(depthPointer, renderMask).greaterThan(attributes.projectedPosition.z + rasterizationParams.depthBias);
-								}
+			Color*         colorPointer   = m_colorData + (boundingBox.getMinY() - m_originY) * m_stride + minX - m_originX;
+			float*         depthPointer   = m_depthData + (boundingBox.getMinY() - m_originY) * m_stride + minX - m_originX;
 
-								if (rasterizationParams.textureMode == TextureMode::Perspective)
-								{
-									attributes.worldPosition /= attributes.inverseW;
-									attributes.textureCoord  /= attributes.inverseW;
-								}
+			for (size_t y = boundingBox.getMinY(); y <= boundingBox.getMaxY(); y += 1, colorPointer += m_stride, depthPointer += m_stride, edgeValue0 += edges[0].stepY, edgeValue1 += edges[1].stepY, edgeValue2 += edges[2].stepY)
+			{
+				const OctInt laneEdgeValues0 = OctInt(clampEdgeValue(edgeValue0)) + laneEdgeSteps0;
+				const OctInt laneEdgeValues1 = OctInt(clampEdgeValue(edgeValue1)) + laneEdgeSteps1;
+				const OctInt laneEdgeValues2 = OctInt(clampEdgeValue(edgeValue2)) + laneEdgeSteps2;
+
+				const size_t lowBlockIndex   = m_hierarchicalDepth.getBlockIndex(minX, y);
+				const size_t highBlockIndex  = hasHighQuad ? m_hierarchicalDepth.getBlockIndex(minX + 4, y) : lowBlockIndex;
+
+				OctMask      renderMask      = laneMask & ~(laneEdgeValues0 | laneEdgeValues1 | laneEdgeValues2).castToMask();
 
-								shader.draw(renderMask, attributes.projectedPosition, attributes.worldPosition, attributes.normal, attributes.textureCoord, colorPointer, depthPointer);
-							}
+				if (testsDepthEarly<pass>(rasterizationParams))
+				{
+					renderMask &= getUnoccludedMask<pass>(lowBlockIndex, highBlockIndex, minDepth);
+				}
 
-							weights0 += quadA12;
-							weights1 += quadA20;
-							weights2 += quadA01;
+				if (renderMask.moveMask())
+				{
+					const QuadFloat offsetsX = QuadFloat(0.0f, 1.0f, 2.0f, 3.0f) + (float(minX) - attributePlanes.origin.projectedPosition.x);
+					const QuadFloat offsetY  = float(y) - attributePlanes.origin.projectedPosition.y;
+					const QuadFloat rowDepth = QuadFloat(attributePlanes.origin.projectedPosition.z) + QuadFloat(attributePlanes.gradientY.projectedPosition.z) * offsetY;
+					const OctFloat  depth    = OctFloat(rowDepth + QuadFloat(attributePlanes.gradientX.projectedPosition.z) * offsetsX, rowDepth + QuadFloat(attributePlanes.gradientX.projectedPosition.z) * (offsetsX + 4.0f));
+
+					renderGroup<pass>(shader, rasterizationParams, renderMask, depth, getRowAttributes<pass>(attributePlanes, offsetY), attributeGradientX, offsetsX, attributePlanes, minX, y, colorPointer, depthPointer);
+				}
+			}
+		}
+
+		// Shades each pixel of the tile once, with the triangle the visibility pass left in front of it. Every quad of
+		// the tile is shaded whole, split only where different triangles meet.
+		void shadeVisibleTriangles(const Tile& tile)
+		{
+			const Rect& bounds = tile.getBounds();
+
+			for (size_t y = bounds.getMinY(); y <= bounds.getMaxY(); ++y)
+			{
+				const size_t   rowOffset      = (y - m_originY) * m_stride;
+				const int32_t* rowTriangleIds = m_triangleIds.data() + rowOffset;
+
+				for (size_t x = bounds.getMinX(); x <= bounds.getMaxX(); x += 4)
+				{
+					const size_t   offset      = x - m_originX;
+					const int32_t* triangleIds = rowTriangleIds + offset;
+					const QuadInt  quadIds(triangleIds, QuadMask(true));
+
+					for (size_t lane = 0; lane < 4; ++lane)
+					{
+						const int32_t triangleId = triangleIds[lane];
+
+						// Each triangle is shaded from the first lane it covers, with all of its lanes at once
+						if (triangleId == s_noTriangle || std::find(triangleIds, triangleIds + lane, triangleId) != triangleIds + lane)
+						{
+							continue;
 						}
 
-						rowWeights0 += quadB12;
-						rowWeights1 += quadB20;
-						rowWeights2 += quadB01;
+						const Triangle&             triangle            = m_frame->triangles[size_t(triangleId)];
+						const RasterizationParams&  rasterizationParams = m_frame->rasterizationParams[triangle.rasterizationParamsIndex];
+						const AttributePlanes&      attributePlanes     = triangle.attributePlanes;
+
+						const QuadMask              laneMask            = quadIds.equal(triangleId);
+						const QuadFloat             offsetsX            = QuadFloat(0.0f, 1.0f, 2.0f, 3.0f) + (float(x) - attributePlanes.origin.projectedPosition.x);
+						const QuadFloat             offsetY             = float(y) - attributePlanes.origin.projectedPosition.y;
+
+						// The visibility pass stored the depth these lanes were tested with, which is what the shader writes back
+						QuadTransformedVertex       attributes          = evaluateAttributes(attributePlanes, offsetsX, offsetY);
+
+						attributes.projectedPosition.z = QuadFloat(m_depthData + rowOffset + offset, laneMask);
+
+						shadeQuad(m_frame->shaders[triangle.shaderIndex], rasterizationParams, laneMask, attributes, attributePlanes, m_colorData + rowOffset + offset, m_depthData + rowOffset + offset);
 					}
 				}
 			}
 		}
 
-		static tr::QuadFloat orientPoints(const QuadVec3& lineStarts, const QuadVec3& lineEnds, const QuadVec3& points)
+		// Depth tests or writes one group of eight pixels, and only then evaluates the other attributes of the quads
+		// that pass and shades them. The offsets are those of the low quad's pixels from the origin of the planes.
+		template <RenderPass pass>
+		void renderGroup(const TShader*               shader,
+		                 const RasterizationParams&   rasterizationParams,
+		                 const OctMask&               coverageMask,
+		                 const OctFloat&              depth,
+		                 const QuadTransformedVertex& rowAttributes,
+		                 const QuadTransformedVertex& attributeGradientX,
+		                 const QuadFloat&             offsetsX,
+		                 const AttributePlanes&       attributePlanes,
+		                 const size_t                 x,
+		                 const size_t                 y,
+		                 Color*                       colorPointer,
+		                 float*                       depthPointer)
 		{
-			return (lineEnds.x - lineStarts.x) * (points.y - lineStarts.y) - (lineEnds.y - lineStarts.y) * (points.x - lineStarts.x);
+			OctMask renderMask = coverageMask;
+
+			if (testsDepthEarly<pass>(rasterizationParams))
+			{
+				const OctFloat storedDepth = OctFloat(depthPointer, renderMask);
+
+				if (pass == RenderPass::Depth || pass == RenderPass::Visibility)
+				{
+					renderMask &= storedDepth.greaterThan(depth + rasterizationParams.depthBias);
+
+					depth.write(depthPointer, renderMask);
+				}
+				else if (pass == RenderPass::ColorEqualDepth)
+				{
+					renderMask &= storedDepth.equal(depth);
+				}
+				else
+				{
+					renderMask &= storedDepth.greaterThan(depth + rasterizationParams.depthBias);
+				}
+			}
+			else if (pass == RenderPass::Depth || pass == RenderPass::Visibility)
+			{
+				// Triangles without a depth test overwrite whatever is there
+				depth.write(depthPointer, renderMask);
+			}
+
+			// Shaders with a late depth test decide which samples pass themselves, so those are counted after shading
+			const bool countsAfterShading = m_queryResult && ShaderTraits<TShader>::s_lateDepthTest && (pass == RenderPass::Color || pass == RenderPass::ColorEqualDepth);
+
+			if (m_queryResult && !countsAfterShading)
+			{
+				*m_queryResult += renderMask.count();
+			}
+
+			if (pass == RenderPass::Visibility)
+			{
+				// The visibility buffer has the same layout as the tile-local depth
+				int32_t* triangleIdPointer = m_triangleIds.data() + (depthPointer - m_depthData);
+
+				QuadInt(m_triangleId).write<instructionSet>(triangleIdPointer,     renderMask.getLow());
+				QuadInt(m_triangleId).write<instructionSet>(triangleIdPointer + 4, renderMask.getHigh());
+			}
+
+			// Triangles without a depth test already wrote their depth in the pre-pass, so the depth their shaders write
+			// is thrown away, or it would overwrite the depths that later triangles are matched against
+			float* shaderDepthPointer = depthPointer;
+
+			if (pass == RenderPass::ColorEqualDepth && !rasterizationParams.depthTest)
+			{
+				OctFloat(depthPointer, renderMask).write(m_discardedDepth.data(), renderMask);
+
+				shaderDepthPointer = m_discardedDepth.data();
+			}
+
+			const OctFloat depthBeforeShading = countsAfterShading ? OctFloat(shaderDepthPointer, renderMask) : OctFloat(0.0f);
+
+			if (renderMask.getLow().moveMask())
+			{
+				if (pass != RenderPass::Depth && pass != RenderPass::Visibility)
+				{
+					shadeQuad(*shader, rasterizationParams, renderMask.getLow(), getQuadAttributes(rowAttributes, attributeGradientX, offsetsX, depth.getLow()), attributePlanes, colorPointer, shaderDepthPointer);
+				}
+
+				m_hierarchicalDepth.update(x, y);
+			}
+
+			if (renderMask.getHigh().moveMask())
+			{
+				if (pass != RenderPass::Depth && pass != RenderPass::Visibility)
+				{
+					shadeQuad(*shader, rasterizationParams, renderMask.getHigh(), getQuadAttributes(rowAttributes, attributeGradientX, offsetsX + 4.0f, depth.getHigh()), attributePlanes, colorPointer + 4, shaderDepthPointer + 4);
+				}
+
+				m_hierarchicalDepth.update(x + 4, y);
+			}
+
+			// The samples that passed are the ones whose depth the shader changed
+			if (countsAfterShading)
+			{
+				*m_queryResult += (renderMask & ~OctFloat(shaderDepthPointer, renderMask).equal(depthBeforeShading)).count();
+			}
+		}
+
+		// Narrows the offsets from the start of a row to the pixels on the inside of one edge, and returns false if
+		// none are left
+		static bool clipRowToEdge(const int64_t rowEdgeValue, const int64_t stepX, int64_t& minOffset, int64_t& maxOffset)
+		{
+			if (stepX > 0)
+			{
+				// First offset where rowEdgeValue + offset * stepX >= 0
+				minOffset = std::max(minOffset, rowEdgeValue >= 0 ? 0 : (stepX - 1 - rowEdgeValue) / stepX);
+			}
+			else if (stepX < 0)
+			{
+				// Last offset where rowEdgeValue + offset * stepX >= 0
+				maxOffset = std::min(maxOffset, rowEdgeValue < 0 ? -1 : rowEdgeValue / -stepX);
+			}
+			else if (rowEdgeValue < 0)
+			{
+				return false;
+			}
+
+			return minOffset <= maxOffset;
+		}
+
+		static OctInt getLaneEdgeSteps(const EdgeFunction& edge)
+		{
+			const int32_t stepX = int32_t(edge.stepX);
+
+			return OctInt(QuadInt(0, stepX, 2 * stepX, 3 * stepX), QuadInt(4 * stepX, 5 * stepX, 6 * stepX, 7 * stepX));
+		}
+
+		// Edge steps between lanes are below 2^26 for buffers up to 32768 pixels wide, so clamping the edge value to
+		// 2^30 keeps every lane in 32 bits without changing any signs
+		static int32_t clampEdgeValue(const int64_t edgeValue)
+		{
+			constexpr int64_t maxEdgeValue = int64_t(1) << 30;
+
+			return int32_t(std::min(std::max(edgeValue, -maxEdgeValue), maxEdgeValue));
+		}
+
+		// Shaders that ask for a late depth test are given every covered pixel when shaded during rasterization, and
+		// test depth themselves
+		template <RenderPass pass>
+		static bool testsDepthEarly(const RasterizationParams& rasterizationParams)
+		{
+			return rasterizationParams.depthTest && !((pass == RenderPass::Color || pass == RenderPass::ColorEqualDepth) && ShaderTraits<TShader>::s_lateDepthTest);
+		}
+
+		// The color pass after a pre-pass accepts depths equal to the stored ones, so blocks are only occluded by
+		// strictly nearer depths there
+		template <RenderPass pass>
+		OctMask getUnoccludedMask(const size_t lowBlockIndex, const size_t highBlockIndex, const float minDepth)
+		{
+			const bool equalDepthPasses = pass == RenderPass::ColorEqualDepth;
+
+			return OctMask(QuadMask(!m_hierarchicalDepth.isOccluded(lowBlockIndex, minDepth, equalDepthPasses)), QuadMask(!m_hierarchicalDepth.isOccluded(highBlockIndex, minDepth, equalDepthPasses)));
+		}
+
+		// Only the attributes that the shader reads are interpolated, the others keep the value of the first vertex
+		static void addAttributes(QuadTransformedVertex& attributes, const QuadTransformedVertex& gradient, const QuadFloat& distance)
+		{
+			attributes.projectedPosition += gradient.projectedPosition * distance;
+
+			if (ShaderTraits<TShader>::s_usesWorldPosition)
+			{
+				attributes.worldPosition += gradient.worldPosition * distance;
+			}
+
+			if (ShaderTraits<TShader>::s_usesNormal)
+			{
+				attributes.normal        += gradient.normal * distance;
+			}
+
+			if (ShaderTraits<TShader>::s_usesTextureCoord)
+			{
+				attributes.textureCoord  += gradient.textureCoord * distance;
+			}
+
+			if (ShaderTraits<TShader>::s_usesInverseW)
+			{
+				attributes.inverseW      += gradient.inverseW * distance;
+			}
+		}
+
+		static QuadTransformedVertex evaluateAttributes(const AttributePlanes& attributePlanes, const QuadFloat& offsetsX, const QuadFloat& offsetY)
+		{
+			QuadTransformedVertex attributes(attributePlanes.origin);
+
+			addAttributes(attributes, QuadTransformedVertex(attributePlanes.gradientX), offsetsX);
+			addAttributes(attributes, QuadTransformedVertex(attributePlanes.gradientY), offsetY);
+
+			return attributes;
+		}
+
+		// Attributes at the start of a row, level with the origin of the planes. The depth and visibility passes don't
+		// run the shader, so they don't need them.
+		template <RenderPass pass>
+		static QuadTransformedVertex getRowAttributes(const AttributePlanes& attributePlanes, const QuadFloat& offsetY)
+		{
+			QuadTransformedVertex attributes(attributePlanes.origin);
+
+			if (pass == RenderPass::Color || pass == RenderPass::ColorEqualDepth)
+			{
+				addAttributes(attributes, QuadTransformedVertex(attributePlanes.gradientY), offsetY);
+			}
+
+			return attributes;
+		}
+
+		// Depth keeps the value it was tested with, so the shader writes exactly what the test compared
+		static QuadTransformedVertex getQuadAttributes(const QuadTransformedVertex& rowAttributes, const QuadTransformedVertex& attributeGradientX, const QuadFloat& offsetsX, const QuadFloat& depth)
+		{
+			QuadTransformedVertex attributes = rowAttributes;
+
+			addAttributes(attributes, attributeGradientX, offsetsX);
+
+			attributes.projectedPosition.z = depth;
+
+			return attributes;
+		}
+
+		static void shadeQuad(const TShader&               shader,
+		                      const RasterizationParams&   rasterizationParams,
+		                      const QuadMask&              mask,
+		                      QuadTransformedVertex        attributes,
+		                      const AttributePlanes&       attributePlanes,
+		                      Color*                       colorPointer,
+		                      float*                       depthPointer)
+		{
+			if (rasterizationParams.textureMode == TextureMode::Perspective)
+			{
+				if (ShaderTraits<TShader>::s_usesWorldPosition)
+				{
+					attributes.worldPosition /= attributes.inverseW;
+				}
+
+				if (ShaderTraits<TShader>::s_usesTextureCoord)
+				{
+					attributes.textureCoord  /= attributes.inverseW;
+				}
+			}
+
+			drawQuad(shader, std::integral_constant<bool, ShaderTraits<TShader>::s_usesDerivatives>(), rasterizationParams, mask, attributes, attributePlanes, colorPointer, depthPointer);
+		}
+
+		static void drawQuad(const TShader&               shader,
+		                     std::false_type,
+		                     const RasterizationParams&,
+		                     const QuadMask&              mask,
+		                     const QuadTransformedVertex& attributes,
+		                     const AttributePlanes&,
+		                     Color*                       colorPointer,
+		                     float*                       depthPointer)
+		{
+			shader.draw(mask, attributes.projectedPosition, attributes.worldPosition, attributes.normal, attributes.textureCoord, colorPointer, depthPointer);
+		}
+
+		// The derivatives come from the attribute planes of the triangle instead of differences between neighbouring
+		// pixels, so they're exact for every pixel and don't need 2x2 blocks to be shaded together
+		static void drawQuad(const TShader&               shader,
+		                     std::true_type,
+		                     const RasterizationParams&   rasterizationParams,
+		                     const QuadMask&              mask,
+		                     const QuadTransformedVertex& attributes,
+		                     const AttributePlanes&       attributePlanes,
+		                     Color*                       colorPointer,
+		                     float*                       depthPointer)
+		{
+			QuadVec2 textureCoordDx(attributePlanes.gradientX.textureCoord);
+			QuadVec2 textureCoordDy(attributePlanes.gradientY.textureCoord);
+
+			if (rasterizationParams.textureMode == TextureMode::Perspective)
+			{
+				// Quotient rule, with the texture coordinate already divided by inverse w
+				const QuadFloat inverseWX(attributePlanes.gradientX.inverseW);
+				const QuadFloat inverseWY(attributePlanes.gradientY.inverseW);
+
+				textureCoordDx = QuadVec2((textureCoordDx.x - attributes.textureCoord.x * inverseWX) / attributes.inverseW, (textureCoordDx.y - attributes.textureCoord.y * inverseWX) / attributes.inverseW);
+				textureCoordDy = QuadVec2((textureCoordDy.x - attributes.textureCoord.x * inverseWY) / attributes.inverseW, (textureCoordDy.y - attributes.textureCoord.y * inverseWY) / attributes.inverseW);
+			}
+
+			shader.draw(mask, attributes.projectedPosition, attributes.worldPosition, attributes.normal, attributes.textureCoord, textureCoordDx, textureCoordDy, colorPointer, depthPointer);
+		}
+
+		// Evaluates the edge functions at the corners of the area that will be traversed, so that whole bounding boxes
+		// can be skipped when one edge has all of them outside, or rendered without edge masks when every edge has
+		// all of them inside
+		static Coverage classifyBoundingBox(const std::array<EdgeFunction, 3>& edges, const Rect& boundingBox, const Rect& tileBounds)
+		{
+			// The last quad in each row can extend past the bounding box
+			const size_t traversedMaxX = boundingBox.getMinX() + ((boundingBox.getMaxX() - boundingBox.getMinX()) | 0x03);
+
+			// Unmasked quads must not write past the edge of the tile, which can only happen at the edge of the viewport
+			bool         full          = traversedMaxX <= tileBounds.getMaxX();
+
+			for (const EdgeFunction& edge : edges)
+			{
+				const int64_t cornerValues[4] = {
+					edge.evaluate(boundingBox.getMinX(), boundingBox.getMinY()),
+					edge.evaluate(traversedMaxX,         boundingBox.getMinY()),
+					edge.evaluate(boundingBox.getMinX(), boundingBox.getMaxY()),
+					edge.evaluate(traversedMaxX,         boundingBox.getMaxY())
+				};
+
+				const int64_t minValue = std::min({ cornerValues[0], cornerValues[1], cornerValues[2], cornerValues[3] });
+				const int64_t maxValue = std::max({ cornerValues[0], cornerValues[1], cornerValues[2], cornerValues[3] });
+
+				if (maxValue < 0)
+				{
+					return Coverage::None;
+				}
+
+				if (minValue < 0)
+				{
+					full = false;
+				}
+			}
+
+			return full ? Coverage::Full : Coverage::Partial;
 		}
 
 	private:
-		bool                                    m_quit;
-		bool                                    m_draw;
-		const std::vector<Tile>&                m_tiles;
-		const std::vector<Triangle>&            m_triangles;
-		const std::vector<TShader>&             m_shaders;
-		const std::vector<RasterizationParams>& m_rasterizationParams;
-		std::atomic<size_t>*                    m_nextTileIndex;
+		// Visibility buffer entry of pixels without a shaded triangle in front
+		static constexpr int32_t                s_noTriangle = -1;
+
+		const size_t                            m_threadIndex;
+		const FrameContext<TShader>*            m_frame;
+		TileScheduler*                          m_tileScheduler;
 		
 		ColorBuffer*                            m_colorBuffer;
 		DepthBuffer*                            m_depthBuffer;
-		std::condition_variable                 m_continueConditionVariable;
-		std::condition_variable                 m_waitConditionVariable;
-		std::mutex                              m_mutex;
-		std::thread                             m_thread;
+		DepthBuffer16*                          m_depthBuffer16;
+		DepthBuffer24*                          m_depthBuffer24;
+
+		Color*                                  m_colorData;
+		float*                                  m_depthData;
+		size_t                                  m_stride;
+		size_t                                  m_originX;
+		size_t                                  m_originY;
+
+		TileBuffer                              m_tileBuffer;
+		HierarchicalDepth                       m_hierarchicalDepth;
+
+		// Counted per thread, so nothing is shared while rendering
+		std::vector<size_t>                     m_queryResults;
+		size_t*                                 m_queryResult;
+
+		// Index of the front-most triangle at each pixel of the tile, for the visibility buffer
+		std::vector<int32_t>                    m_triangleIds;
+		int32_t                                 m_triangleId;
+
+		// Where shaders write the depth that's thrown away, one group of eight pixels at a time
+		std::array<float, 8>                    m_discardedDepth;
 	};
 }
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "trColorBuffer.hpp"
+#include "trDepthBuffer.hpp"
+#include "trFrameContext.hpp"
+#include "trTileScheduler.hpp"
+
+namespace tr
+{
+	// Render threads are compiled once for each kernel instruction set, and the tile manager holds those of the one
+	// the rasterizer was created with through this
+	template <typename TShader>
+	class RenderThreadBase
+	{
+	public:
+		virtual        ~RenderThreadBase() {}
+
+		// The color buffer is null for depth-only draws
+		virtual void   draw(const FrameContext<TShader>& frame, TileScheduler& tileScheduler, tr::ColorBuffer* colorBuffer, tr::DepthBuffer& depthBuffer) = 0;
+
+		// Fixed-point depth buffers are only drawn to by depth-only draws
+		virtual void   draw(const FrameContext<TShader>& frame, TileScheduler& tileScheduler, tr::DepthBuffer16& depthBuffer) = 0;
+		virtual void   draw(const FrameContext<TShader>& frame, TileScheduler& tileScheduler, tr::DepthBuffer24& depthBuffer) = 0;
+
+		// Samples this thread counted for a query in the last frame it drew
+		virtual size_t getQueryResult(const size_t queryIndex) const = 0;
+	};
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "trColor.hpp"
+#include "trQuadMask.hpp"
+#include "trQuadVec2.hpp"
+#include "trQuadVec3.hpp"
+#include <type_traits>
+#include <utility>
+
+namespace tr
+{
+	// Shaders that have a draw overload which also takes the screen space derivatives of the texture coordinate,
+	// after the texture coordinate itself, are given them. Others don't pay for computing them.
+	template <typename TShader, typename = void>
+	struct ShaderUsesDerivatives : std::false_type
+	{
+	};
+
+	template <typename TShader>
+	struct ShaderUsesDerivatives<TShader, decltype(std::declval<const TShader&>().draw(std::declval<const QuadMask&>(),
+	                                                                                  std::declval<const QuadVec3&>(),
+	                                                                                  std::declval<const QuadVec3&>(),
+	                                                                                  std::declval<const QuadVec3&>(),
+	                                                                                  std::declval<const QuadVec2&>(),
+	                                                                                  std::declval<const QuadVec2&>(),
+	                                                                                  std::declval<const QuadVec2&>(),
+	                                                                                  std::declval<Color*>(),
+	                                                                                  std::declval<float*>()), void())> : std::true_type
+	{
+	};
+
+	// Shaders can declare the attributes they don't read with static constexpr bool members, which are then left
+	// uninterpolated and hold the value of the first vertex:
+	//
+	//     static constexpr bool s_usesWorldPosition = false;
+	//     static constexpr bool s_usesNormal        = false;
+	//     static constexpr bool s_usesTextureCoord  = false;
+	//
+	// Attributes that aren't declared are assumed to be used. The projected position is always interpolated, since
+	// depth testing needs it.
+	template <typename TShader, typename = void>
+	struct ShaderUsesWorldPosition : std::true_type
+	{
+	};
+
+	template <typename TShader>
+	struct ShaderUsesWorldPosition<TShader, decltype(void(TShader::s_usesWorldPosition))> : std::integral_constant<bool, TShader::s_usesWorldPosition>
+	{
+	};
+
+	template <typename TShader, typename = void>
+	struct ShaderUsesNormal : std::true_type
+	{
+	};
+
+	template <typename TShader>
+	struct ShaderUsesNormal<TShader, decltype(void(TShader::s_usesNormal))> : std::integral_constant<bool, TShader::s_usesNormal>
+	{
+	};
+
+	template <typename TShader, typename = void>
+	struct ShaderUsesTextureCoord : std::true_type
+	{
+	};
+
+	template <typename TShader>
+	struct ShaderUsesTextureCoord<TShader, decltype(void(TShader::s_usesTextureCoord))> : std::integral_constant<bool, TShader::s_usesTextureCoord>
+	{
+	};
+
+	// The depth test normally comes before the shader runs, and the shader is only given pixels that pass it.
+	// Shaders that write a depth other than the one they're given can declare
+	//
+	//     static constexpr bool s_lateDepthTest = true;
+	//
+	// to be given every covered pixel instead, without hierarchical depth rejection, and test depth themselves
+	// against the depth pointer. Their triangles are left out of depth pre-passes. Visibility-buffer draws still
+	// test depth before shading.
+	template <typename TShader, typename = void>
+	struct ShaderLateDepthTest : std::false_type
+	{
+	};
+
+	template <typename TShader>
+	struct ShaderLateDepthTest<TShader, decltype(void(TShader::s_lateDepthTest))> : std::integral_constant<bool, TShader::s_lateDepthTest>
+	{
+	};
+
+	template <typename TShader>
+	struct ShaderTraits
+	{
+		static constexpr bool s_usesWorldPosition = ShaderUsesWorldPosition<TShader>::value;
+		static constexpr bool s_usesNormal        = ShaderUsesNormal<TShader>::value;
+		static constexpr bool s_usesTextureCoord  = ShaderUsesTextureCoord<TShader>::value || ShaderUsesDerivatives<TShader>::value;
+		static constexpr bool s_usesDerivatives   = ShaderUsesDerivatives<TShader>::value;
+		static constexpr bool s_lateDepthTest     = ShaderLateDepthTest<TShader>::value;
+
+		// Inverse w is only needed to undo the perspective division of other attributes
+		static constexpr bool s_usesInverseW      = s_usesWorldPosition || s_usesTextureCoord;
+	};
+}
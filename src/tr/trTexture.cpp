@@ -91,30 +91,22 @@ tr::QuadColor tr::Texture::getAt(const QuadFloat& u, const QuadFloat& v, const b
 	return m_baseLevel->getAt(u, v, filter, textureWrappingMode, mask);
 }
 
-//tr::Color tr::Texture::getAt(const float u, const float v, const bool filter, const TextureWrappingMode textureWrappingMode, const float du, const float dv, const bool interpolateMipmapLevels) const
-//{
-//	const float dx       = du * m_baseLevel->getFloatWidth();
-//	const float dy       = dv * m_baseLevel->getFloatHeight();
-//	const float mipLevel = fastLog2(std::max(dx, dy));
-//
-//	if (interpolateMipmapLevels)
-//	{
-//		const size_t  floor      = std::min(size_t(mipLevel), m_maxMipLevelIndex);
-//		const size_t  ceil       = std::min(floor + 1,        m_maxMipLevelIndex);
-//
-//		const float   ceilRatio  = mipLevel - float(floor);
-//		const float   floorRatio = 1.0f - ceilRatio;
-//
-//		const Vector4 floorColor = Vector4();// m_mipLevels[floor].getAt(u, v, filter, textureWrappingMode).toVector();
-//		const Vector4 ceilColor  = Vector4();// m_mipLevels[ceil].getAt(u, v, filter, textureWrappingMode).toVector();
-//
-//		return Color(floorColor * floorRatio + ceilColor * ceilRatio);
-//	}
-//	else
-//	{
-//		return tr::Color();//m_mipLevels[std::min(size_t(std::lroundf(mipLevel)), m_mipLevels.size() - 1)].getAt(u, v, filter, textureWrappingMode);
-//	}
-//}
+// Picks one mip level for the whole quad from the largest footprint among its pixels, like GPUs do for each 2x2
+// block
+tr::QuadColor tr::Texture::getAt(const QuadFloat& u, const QuadFloat& v, const QuadVec2& dx, const QuadVec2& dy, const bool filter, const TextureWrappingMode textureWrappingMode, const QuadMask& mask) const
+{
+	const QuadFloat widthSquared(m_baseLevel->getFloatWidth()   * m_baseLevel->getFloatWidth());
+	const QuadFloat heightSquared(m_baseLevel->getFloatHeight() * m_baseLevel->getFloatHeight());
+
+	const QuadFloat lengthSquaredX   = dx.x * dx.x * widthSquared + dx.y * dx.y * heightSquared;
+	const QuadFloat lengthSquaredY   = dy.x * dy.x * widthSquared + dy.y * dy.y * heightSquared;
+	const float     maxLengthSquared = QuadFloat(0.0f).maskedCopy(lengthSquaredX.max(lengthSquaredY), mask).horizontalMax();
+
+	// Halving the log of the squared length saves a square root
+	const float     mipLevel         = 0.5f * fastLog2(maxLengthSquared);
+
+	return m_mipLevels[std::min(size_t(std::max(mipLevel, 0.0f)), m_maxMipLevelIndex)].getAt(u, v, filter, textureWrappingMode, mask);
+}
 
 tr::QuadColor tr::Texture::getAt(const QuadFloat& u, const QuadFloat& v, const QuadMask& mask) const
 {
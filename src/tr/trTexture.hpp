@@ -2,6 +2,7 @@
 
 #include "trColorBuffer.hpp"
 #include "trQuadColor.hpp"
+#include "trQuadVec2.hpp"
 
 namespace tr
 {
@@ -19,7 +20,7 @@ namespace tr
 		const ColorBuffer&       getConstMipLevel(const size_t mipLevel) const;
 		size_t                   getNumMipLevels() const;
 		QuadColor                getAt(const QuadFloat& u, const QuadFloat& v, const bool filter, const TextureWrappingMode textureWrappingMode, const QuadMask& mask) const;
-		//Color                    getAt(const float u, const float v, const bool filter, const TextureWrappingMode textureWrappingMode, const float du, const float dv, const bool interpolateMipmapLevels) const;
+		QuadColor                getAt(const QuadFloat& u, const QuadFloat& v, const QuadVec2& dx, const QuadVec2& dy, const bool filter, const TextureWrappingMode textureWrappingMode, const QuadMask& mask) const;
 		QuadColor                getAt(const QuadFloat& u, const QuadFloat& v, const QuadMask& mask) const;
 
 	private:
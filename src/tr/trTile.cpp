@@ -1,7 +1,8 @@
 #include "trTile.hpp"
 
 tr::Tile::Tile(const Rect bounds) :
-	m_bounds(bounds)
+	m_bounds(bounds),
+	m_cost(0)
 {
 }
 
@@ -9,3 +10,28 @@ const tr::Rect& tr::Tile::getBounds() const
 {
 	return m_bounds;
 }
+
+const std::vector<size_t>& tr::Tile::getTriangleIndices() const
+{
+	return m_triangleIndices;
+}
+
+size_t tr::Tile::getCost() const
+{
+	return m_cost;
+}
+
+void tr::Tile::addTriangleIndex(const size_t triangleIndex, const size_t coveredArea, const bool small)
+{
+	m_triangleIndices.push_back(triangleIndex);
+
+	m_cost += (small ? s_smallTriangleCost : s_triangleCost) + coveredArea;
+}
+
+void tr::Tile::clear()
+{
+	// Keeps the capacity so the bins don't have to grow again every frame
+	m_triangleIndices.clear();
+
+	m_cost = 0;
+}
\ No newline at end of file
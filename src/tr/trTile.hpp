@@ -1,17 +1,30 @@
 #pragma once
 
 #include "trRect.hpp"
+#include <vector>
 
 namespace tr
 {
 	class Tile
 	{
 	public:
-		            Tile(const Rect boundingBox);
+		// Rough cost of setting up a triangle in a tile, in pixels
+		static constexpr size_t    s_triangleCost      = 64;
+		static constexpr size_t    s_smallTriangleCost = 16;
 
-		const Rect& getBounds() const;
+	public:
+		                           Tile(const Rect boundingBox);
+
+		const Rect&                getBounds() const;
+		const std::vector<size_t>& getTriangleIndices() const;
+		size_t                     getCost() const;
+
+		void                       addTriangleIndex(const size_t triangleIndex, const size_t coveredArea, const bool small);
+		void                       clear();
 
 	private:
-		const Rect  m_bounds;
+		const Rect                 m_bounds;
+		std::vector<size_t>        m_triangleIndices;
+		size_t                     m_cost;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,157 @@
+#include "trTileBuffer.hpp"
+#include "trFixedPointDepth.hpp"
+#include <algorithm>
+#include <cstring>
+
+tr::TileBuffer::TileBuffer() :
+	m_colorData(nullptr),
+	m_depthData(nullptr),
+	m_stride(0),
+	m_minX(0),
+	m_minY(0),
+	m_width(0),
+	m_height(0)
+{
+}
+
+void tr::TileBuffer::load(const ColorBuffer& colorBuffer, const DepthBuffer& depthBuffer, const Rect& bounds, const PendingClear& pendingClear)
+{
+	allocate(bounds);
+
+	const Color* colorSource = colorBuffer.getData() + m_minY * colorBuffer.getWidth() + m_minX;
+	const float* depthSource = depthBuffer.getData() + m_minY * depthBuffer.getWidth() + m_minX;
+
+	for (size_t y = 0; y < m_height; ++y, colorSource += colorBuffer.getWidth(), depthSource += depthBuffer.getWidth())
+	{
+		if (pendingClear.clearColor)
+		{
+			std::fill(m_colorData + y * m_stride, m_colorData + y * m_stride + m_width, pendingClear.color);
+		}
+		else
+		{
+			std::memcpy(m_colorData + y * m_stride, colorSource, m_width * sizeof(Color));
+		}
+
+		if (pendingClear.clearDepth)
+		{
+			std::fill(m_depthData + y * m_stride, m_depthData + y * m_stride + m_width, pendingClear.depth);
+		}
+		else
+		{
+			std::memcpy(m_depthData + y * m_stride, depthSource, m_width * sizeof(float));
+		}
+	}
+}
+
+void tr::TileBuffer::store(ColorBuffer& colorBuffer, DepthBuffer& depthBuffer, const bool writeDepth) const
+{
+	Color* colorDestination = colorBuffer.getData() + m_minY * colorBuffer.getWidth() + m_minX;
+	float* depthDestination = depthBuffer.getData() + m_minY * depthBuffer.getWidth() + m_minX;
+
+	for (size_t y = 0; y < m_height; ++y, colorDestination += colorBuffer.getWidth(), depthDestination += depthBuffer.getWidth())
+	{
+		std::memcpy(colorDestination, m_colorData + y * m_stride, m_width * sizeof(Color));
+
+		if (writeDepth)
+		{
+			std::memcpy(depthDestination, m_depthData + y * m_stride, m_width * sizeof(float));
+		}
+	}
+}
+
+void tr::TileBuffer::load(const DepthBuffer16& depthBuffer, const Rect& bounds, const PendingClear& pendingClear)
+{
+	allocate(bounds);
+
+	if (pendingClear.clearDepth)
+	{
+		std::fill(m_depthData, m_depthData + m_stride * m_height, pendingClear.depth);
+
+		return;
+	}
+
+	const uint16_t* depthSource = depthBuffer.getData() + m_minY * depthBuffer.getWidth() + m_minX;
+
+	for (size_t y = 0; y < m_height; ++y, depthSource += depthBuffer.getWidth())
+	{
+		FixedPointDepth::decode(depthSource, m_depthData + y * m_stride, m_width);
+	}
+}
+
+void tr::TileBuffer::load(const DepthBuffer24& depthBuffer, const Rect& bounds, const PendingClear& pendingClear)
+{
+	allocate(bounds);
+
+	if (pendingClear.clearDepth)
+	{
+		std::fill(m_depthData, m_depthData + m_stride * m_height, pendingClear.depth);
+
+		return;
+	}
+
+	const Depth24*  depthSource = depthBuffer.getData() + m_minY * depthBuffer.getWidth() + m_minX;
+
+	for (size_t y = 0; y < m_height; ++y, depthSource += depthBuffer.getWidth())
+	{
+		FixedPointDepth::decode(depthSource, m_depthData + y * m_stride, m_width);
+	}
+}
+
+void tr::TileBuffer::store(DepthBuffer16& depthBuffer) const
+{
+	uint16_t* depthDestination = depthBuffer.getData() + m_minY * depthBuffer.getWidth() + m_minX;
+
+	for (size_t y = 0; y < m_height; ++y, depthDestination += depthBuffer.getWidth())
+	{
+		FixedPointDepth::encode(m_depthData + y * m_stride, depthDestination, m_width);
+	}
+}
+
+void tr::TileBuffer::store(DepthBuffer24& depthBuffer) const
+{
+	Depth24*  depthDestination = depthBuffer.getData() + m_minY * depthBuffer.getWidth() + m_minX;
+
+	for (size_t y = 0; y < m_height; ++y, depthDestination += depthBuffer.getWidth())
+	{
+		FixedPointDepth::encode(m_depthData + y * m_stride, depthDestination, m_width);
+	}
+}
+
+tr::Color* tr::TileBuffer::getColorData()
+{
+	return m_colorData;
+}
+
+float* tr::TileBuffer::getDepthData()
+{
+	return m_depthData;
+}
+
+size_t tr::TileBuffer::getStride() const
+{
+	return m_stride;
+}
+
+void tr::TileBuffer::allocate(const Rect& bounds)
+{
+	m_minX   = bounds.getMinX();
+	m_minY   = bounds.getMinY();
+	m_width  = bounds.getMaxX() - bounds.getMinX() + 1;
+	m_height = bounds.getMaxY() - bounds.getMinY() + 1;
+	m_stride = (m_width + s_rowAlignment - 1) / s_rowAlignment * s_rowAlignment;
+
+	const size_t planeSize = m_stride * m_height * sizeof(float);
+
+	static_assert(sizeof(Color) == sizeof(float), "Color and depth planes share a stride");
+
+	if (m_storage.size() < 2 * planeSize + s_alignment)
+	{
+		m_storage.resize(2 * planeSize + s_alignment);
+	}
+
+	const uintptr_t alignedAddress = (reinterpret_cast<uintptr_t>(m_storage.data()) + s_alignment - 1) & ~uintptr_t(s_alignment - 1);
+
+	m_colorData = reinterpret_cast<Color*>(alignedAddress);
+	m_depthData = reinterpret_cast<float*>(alignedAddress + planeSize);
+}
+
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "trColorBuffer.hpp"
+#include "trDepthBuffer.hpp"
+#include "trPendingClear.hpp"
+#include "trRect.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace tr
+{
+	// Contiguous copy of one tile's color and depth, so a render thread works on a few cache-aligned rows instead of
+	// rows that are a whole framebuffer apart
+	class TileBuffer
+	{
+	public:
+		                        TileBuffer();
+
+		// Planes with a pending clear start from its values, without reading the buffers
+		void                    load(const ColorBuffer& colorBuffer, const DepthBuffer& depthBuffer, const Rect& bounds, const PendingClear& pendingClear);
+		void                    store(ColorBuffer& colorBuffer, DepthBuffer& depthBuffer, const bool writeDepth) const;
+
+		// Fixed-point depth is converted to float for the tile, and back when it's stored
+		void                    load(const DepthBuffer16& depthBuffer, const Rect& bounds, const PendingClear& pendingClear);
+		void                    load(const DepthBuffer24& depthBuffer, const Rect& bounds, const PendingClear& pendingClear);
+		void                    store(DepthBuffer16& depthBuffer) const;
+		void                    store(DepthBuffer24& depthBuffer) const;
+
+		Color*                  getColorData();
+		float*                  getDepthData();
+		size_t                  getStride() const;
+
+	private:
+		void                    allocate(const Rect& bounds);
+
+	private:
+		static constexpr size_t s_alignment = 64;
+
+		// Rows are padded to whole cache lines, which also leaves room for the last quad of a row
+		static constexpr size_t s_rowAlignment = s_alignment / sizeof(float);
+
+		std::vector<uint8_t>    m_storage;
+		Color*                  m_colorData;
+		float*                  m_depthData;
+		size_t                  m_stride;
+		size_t                  m_minX;
+		size_t                  m_minY;
+		size_t                  m_width;
+		size_t                  m_height;
+	};
+}
@@ -1,19 +1,24 @@
 #pragma once
 
 #include <vector>
+#include <algorithm>
+#include <array>
 #include <cassert>
-#include <thread>
-#include <atomic>
 #include <memory>
-#include <condition_variable>
 #include <string>
 #include "trTile.hpp"
 #include "trColorBuffer.hpp"
+#include "trCpu.hpp"
 #include "trDepthBuffer.hpp"
+#include "trFrameContext.hpp"
+#include "trFrameHandle.hpp"
 #include "trInvalidSettingException.hpp"
 #include "trRasterizationParams.hpp"
 #include "trTriangle.hpp"
 #include "trRenderThread.hpp"
+#include "trTileScheduler.hpp"
+#include "trTileSizeSelector.hpp"
+#include "trWorkerPool.hpp"
 
 namespace tr
 {
@@ -21,10 +26,31 @@ namespace tr
 	class TileManager
 	{
 	public:
-		TileManager(const size_t viewportWidth, const size_t viewportHeight, const size_t tileWidth, const size_t tileHeight) :
+		TileManager(const size_t viewportWidth, const size_t viewportHeight, const size_t tileWidth, const size_t tileHeight, const InstructionSet instructionSet) :
 			m_viewportWidth(0),
-			m_viewportHeight(0)
+			m_viewportHeight(0),
+			m_tileWidth(0),
+			m_tileHeight(0),
+			m_numTilesX(0),
+			m_numTilesY(0),
+			m_currentFrameIndex(0),
+			m_adaptiveTileSize(false),
+			m_tileLocalBuffers(false),
+			m_depthBufferWriteBack(true),
+			m_depthPrepass(false),
+			m_visibilityBuffer(false),
+			m_nextTileWidth(0),
+			m_nextTileHeight(0),
+			m_lastJobNumber(0),
+			m_numDrawingThreads(0),
+			m_numDrawnQueries(0),
+			m_instructionSet(instructionSet)
 		{
+			if (instructionSet > Cpu::getSupportedInstructionSet())
+			{
+				throw InvalidSettingException("Instruction set is not supported by this CPU and build");
+			}
+
 			setAttributes(viewportWidth, viewportHeight, tileWidth, tileHeight);
 		}
 
@@ -35,73 +61,247 @@ namespace tr
 				throw InvalidSettingException("Viewport dimensions must be non-zero");
 			}
 			
+			if (tileWidth == 0 || tileHeight == 0)
+			{
+				throw InvalidSettingException("Tile dimensions must be non-zero");
+			}
+
 			if (tileWidth % 4 != 0)
 			{
 				throw InvalidSettingException("Tile width must be divisible by 4");
 			}
 
+			// Tiles can't change under a frame that is still being rendered
+			m_workerPool.wait();
+
 			m_viewportWidth  = viewportWidth;
 			m_viewportHeight = viewportHeight;
+			m_tileWidth      = tileWidth;
+			m_tileHeight     = tileHeight;
+			m_nextTileWidth  = tileWidth;
+			m_nextTileHeight = tileHeight;
+			m_numTilesX      = (viewportWidth  + tileWidth  - 1) / tileWidth;
+			m_numTilesY      = (viewportHeight + tileHeight - 1) / tileHeight;
+
+			for (FrameContext<TShader>& frame : m_frames)
+			{
+				createTiles(frame);
+			}
+		}
+
+		size_t storeShader(const TShader& shader)
+		{
+			std::vector<TShader>& shaders = m_frames[m_currentFrameIndex].shaders;
+
+			shaders.push_back(shader);
+
+			return shaders.size() - 1;
+		}
+
+		size_t storeRasterizationParams(const bool depthTest, const float depthBias, const TextureMode textureMode, const size_t queryIndex)
+		{
+			std::vector<RasterizationParams>& rasterizationParams = m_frames[m_currentFrameIndex].rasterizationParams;
+
+			rasterizationParams.push_back({ depthTest, depthBias, textureMode, queryIndex });
+
+			return rasterizationParams.size() - 1;
+		}
+
+		size_t addQuery()
+		{
+			return m_frames[m_currentFrameIndex].numQueries++;
+		}
 
-			m_tiles.clear();
+		// Each render thread counts the samples of its own tiles, and the counts are only added up here. Results are
+		// from the last frame drawn, so this waits for it if it's still in flight.
+		size_t getQueryResult(const size_t queryIndex)
+		{
+			m_workerPool.wait();
 
-			for (size_t y = 0; y < viewportHeight; y += tileHeight)
+			if (queryIndex >= m_numDrawnQueries)
 			{
-				size_t tileMaxY = y + tileHeight - 1;
+				throw InvalidSettingException(std::string("Query ") +
+				                                          std::to_string(queryIndex) +
+				                                          " was not issued in the last frame drawn");
+			}
 
-				if (tileMaxY >= viewportHeight)
-				{
-					tileMaxY = viewportHeight - 1;
-				}
+			size_t numSamples = 0;
 
-				for (size_t x = 0; x < viewportWidth; x += tileWidth)
-				{
-					size_t tileMaxX = x + tileWidth - 1;
+			for (const std::unique_ptr<RenderThreadBase<TShader>>& thread : m_threads)
+			{
+				numSamples += thread->getQueryResult(queryIndex);
+			}
 
-					if (tileMaxX >= viewportWidth)
-					{
-						tileMaxX = viewportWidth - 1;
-					}
+			return numSamples;
+		}
 
-					m_tiles.emplace_back(Rect(x, y, tileMaxX, tileMaxY));
-				}
+		// Triangles are assembled straight into the frame being queued, which is never the one in flight, and binned
+		// once they're all in place
+		std::vector<Triangle>& getQueuedTriangles()
+		{
+			return m_frames[m_currentFrameIndex].triangles;
+		}
+
+		void binQueuedTriangles(const size_t firstTriangleIndex)
+		{
+			FrameContext<TShader>& frame = m_frames[m_currentFrameIndex];
+
+			for (size_t triangleIndex = firstTriangleIndex; triangleIndex < frame.triangles.size(); ++triangleIndex)
+			{
+				// Triangles that fit in one group of eight pixels per row, in at most eight rows, are rendered without
+				// the per-tile setup that pays off for larger ones
+				Triangle&   triangle    = frame.triangles[triangleIndex];
+				const Rect& boundingBox = triangle.boundingBox;
+
+				triangle.small = boundingBox.getMaxX() - boundingBox.getMinX() < s_smallTriangleSize &&
+				                 boundingBox.getMaxY() - boundingBox.getMinY() < s_smallTriangleSize;
+
+				binTriangle(frame, triangleIndex);
 			}
 		}
 
-		size_t storeShader(const TShader& shader)
+		// Threads rendering the frame in flight, which spin until it's done, or none once it is
+		size_t getNumDrawingThreads() const
+		{
+			return m_workerPool.isComplete(m_lastJobNumber) ? 0 : m_numDrawingThreads;
+		}
+
+		InstructionSet getInstructionSet() const
+		{
+			return m_instructionSet;
+		}
+
+		// Lets the tile manager pick the tile dimensions itself. The size chosen from one frame is applied when the
+		// next one begins, while it's still empty.
+		void setAdaptiveTileSize(const bool adaptiveTileSize)
 		{
-			m_shaders.push_back(shader);
+			m_adaptiveTileSize = adaptiveTileSize;
+		}
 
-			return m_shaders.size() - 1;
+		// Renders each tile into a small buffer of its own and copies it to the color and depth buffers when done
+		void setTileLocalBuffers(const bool tileLocalBuffers)
+		{
+			m_tileLocalBuffers = tileLocalBuffers;
 		}
 
-		size_t storeRasterizationParams(const bool depthTest, const float depthBias, const TextureMode textureMode)
+		// Leaves the depth buffer untouched when rendering with tile-local buffers, for when it's not needed after the
+		// frame
+		void setDepthBufferWriteBack(const bool depthBufferWriteBack)
 		{
-			m_rasterizationParams.push_back({ depthTest, depthBias, textureMode });
+			m_depthBufferWriteBack = depthBufferWriteBack;
+		}
 
-			return m_rasterizationParams.size() - 1;
+		// Rasterizes every tile twice: first only depth, then shading just the fragments that ended up in front, so
+		// each pixel is shaded once. Shaders must write the interpolated depth as it is.
+		void setDepthPrepass(const bool depthPrepass)
+		{
+			m_depthPrepass = depthPrepass;
 		}
 
-		void queue(const Triangle& triangle)
+		// Rasterizes every tile into a buffer of triangle indices first, then shades each pixel once with the triangle
+		// in front of it, however many were drawn over it. Only suits shaders whose result doesn't depend on what's
+		// behind, and renders with tile-local buffers.
+		void setVisibilityBuffer(const bool visibilityBuffer)
 		{
-			m_triangles.push_back(triangle);
+			m_visibilityBuffer = visibilityBuffer;
 		}
 
 		void clear()
 		{
-			m_triangles.clear();
-			m_shaders.clear();
-			m_rasterizationParams.clear();
+			beginFrame();
+		}
+
+		void queueClear(const Color& color, const float depth)
+		{
+			PendingClear& pendingClear = m_frames[m_currentFrameIndex].pendingClear;
+
+			pendingClear.clearColor = true;
+			pendingClear.clearDepth = true;
+			pendingClear.color      = color;
+			pendingClear.depth      = depth;
+		}
+
+		void queueDepthClear(const float depth)
+		{
+			PendingClear& pendingClear = m_frames[m_currentFrameIndex].pendingClear;
+
+			pendingClear.clearDepth = true;
+			pendingClear.depth      = depth;
 		}
 
 		void draw(const size_t numThreads, ColorBuffer& colorBuffer, DepthBuffer& depthBuffer)
 		{
-			if (size_t(colorBuffer.getWidth()) != m_viewportWidth || size_t(colorBuffer.getHeight()) != m_viewportHeight)
+			prepareDraw(numThreads, &colorBuffer, depthBuffer);
+
+			const FrameContext<TShader>& frame = m_frames[m_currentFrameIndex];
+
+			m_workerPool.run(numThreads, [&](const size_t threadIndex)
+			{
+				m_threads[threadIndex]->draw(frame, m_tileScheduler, &colorBuffer, depthBuffer);
+			});
+		}
+
+		// Renders only the depth of the queued triangles, without running any shaders
+		void drawDepth(const size_t numThreads, DepthBuffer& depthBuffer)
+		{
+			prepareDraw(numThreads, nullptr, depthBuffer);
+
+			const FrameContext<TShader>& frame = m_frames[m_currentFrameIndex];
+
+			m_workerPool.run(numThreads, [&](const size_t threadIndex)
+			{
+				m_threads[threadIndex]->draw(frame, m_tileScheduler, nullptr, depthBuffer);
+			});
+		}
+
+		// Depth-only draws into a DepthBuffer16 or DepthBuffer24
+		template <typename TDepthBuffer>
+		void drawDepth(const size_t numThreads, TDepthBuffer& depthBuffer)
+		{
+			prepareDraw(numThreads, nullptr, depthBuffer);
+
+			const FrameContext<TShader>& frame = m_frames[m_currentFrameIndex];
+
+			m_workerPool.run(numThreads, [&](const size_t threadIndex)
+			{
+				m_threads[threadIndex]->draw(frame, m_tileScheduler, depthBuffer);
+			});
+		}
+
+		// Starts rendering the queued triangles on the worker threads and returns straight away, so the next frame can
+		// be queued in the meantime. The buffers must stay alive and untouched until the handle reports completion.
+		FrameHandle drawAsync(const size_t numThreads, ColorBuffer& colorBuffer, DepthBuffer& depthBuffer)
+		{
+			prepareDraw(numThreads, &colorBuffer, depthBuffer);
+
+			const FrameContext<TShader>* frame       = &m_frames[m_currentFrameIndex];
+			ColorBuffer*                 colorPointer = &colorBuffer;
+			DepthBuffer*                 depthPointer = &depthBuffer;
+
+			m_numDrawingThreads = numThreads;
+			m_lastJobNumber     = m_workerPool.start(numThreads, [this, frame, colorPointer, depthPointer](const size_t threadIndex)
+			{
+				m_threads[threadIndex]->draw(*frame, m_tileScheduler, colorPointer, *depthPointer);
+			});
+
+			// Only one frame can be rendered at a time, so the next context is free by now
+			m_currentFrameIndex = (m_currentFrameIndex + 1) % s_numFrames;
+			beginFrame();
+
+			return FrameHandle(m_workerPool, m_lastJobNumber);
+		}
+
+	private:
+		// The color buffer is null for depth-only draws
+		template <typename TDepthBuffer>
+		void prepareDraw(const size_t numThreads, ColorBuffer* colorBuffer, const TDepthBuffer& depthBuffer)
+		{
+			if (colorBuffer && (size_t(colorBuffer->getWidth()) != m_viewportWidth || size_t(colorBuffer->getHeight()) != m_viewportHeight))
 			{
 				throw InvalidSettingException(std::string("Color buffer dimensions (") +
-				                                          std::to_string(colorBuffer.getWidth()) +
+				                                          std::to_string(colorBuffer->getWidth()) +
 				                                          "," +
-				                                          std::to_string(colorBuffer.getHeight()) +
+				                                          std::to_string(colorBuffer->getHeight()) +
 				                                          ") do not match TileManager settings (" +
 				                                          std::to_string(m_viewportWidth) +
 				                                          "," +
@@ -122,42 +322,144 @@ namespace tr
 				                                          ")");
 			}
 
+			// The render threads and the scheduler belong to the frame in flight until it's done
+			m_workerPool.wait();
+
 			if (numThreads != m_threads.size())
 			{
 				initThreads(numThreads);
 			}
 
-			std::atomic<size_t> nextTileIndex  = 0;
+			if (m_adaptiveTileSize)
+			{
+				m_tileSizeSelector.select(m_frames[m_currentFrameIndex].triangles, numThreads, m_viewportWidth, m_viewportHeight, m_nextTileWidth, m_nextTileHeight);
+			}
+
+			m_frames[m_currentFrameIndex].tileLocalBuffers     = m_tileLocalBuffers;
+			m_frames[m_currentFrameIndex].depthBufferWriteBack = m_depthBufferWriteBack;
+			m_frames[m_currentFrameIndex].depthPrepass         = m_depthPrepass;
+			m_frames[m_currentFrameIndex].visibilityBuffer     = m_visibilityBuffer;
+			m_frames[m_currentFrameIndex].depthOnly            = colorBuffer == nullptr;
 
-			for (auto& thread : m_threads)
+			m_numDrawnQueries = m_frames[m_currentFrameIndex].numQueries;
+
+			m_tileScheduler.schedule(m_frames[m_currentFrameIndex].tiles, numThreads);
+		}
+
+		void beginFrame()
+		{
+			FrameContext<TShader>& frame = m_frames[m_currentFrameIndex];
+
+			frame.clear();
+
+			if (m_nextTileWidth != m_tileWidth || m_nextTileHeight != m_tileHeight)
 			{
-				thread->draw(nextTileIndex, colorBuffer, depthBuffer);
+				m_tileWidth  = m_nextTileWidth;
+				m_tileHeight = m_nextTileHeight;
+				m_numTilesX  = (m_viewportWidth  + m_tileWidth  - 1) / m_tileWidth;
+				m_numTilesY  = (m_viewportHeight + m_tileHeight - 1) / m_tileHeight;
 			}
 
-			for (auto& thread : m_threads)
+			// Only the frame that's about to be queued is re-tiled, so a frame still in flight keeps its tiles and
+			// isn't waited for. The others are re-tiled when their turn comes.
+			if (frame.tileWidth != m_tileWidth || frame.tileHeight != m_tileHeight)
 			{
-				thread->wait();
+				createTiles(frame);
+			}
+		}
+
+		void createTiles(FrameContext<TShader>& frame)
+		{
+			frame.tiles.clear();
+
+			for (size_t y = 0; y < m_viewportHeight; y += m_tileHeight)
+			{
+				const size_t tileMaxY = std::min(y + m_tileHeight - 1, m_viewportHeight - 1);
+
+				for (size_t x = 0; x < m_viewportWidth; x += m_tileWidth)
+				{
+					const size_t tileMaxX = std::min(x + m_tileWidth - 1, m_viewportWidth - 1);
+
+					frame.tiles.emplace_back(Rect(x, y, tileMaxX, tileMaxY));
+				}
+			}
+
+			frame.tileWidth  = m_tileWidth;
+			frame.tileHeight = m_tileHeight;
+
+			for (size_t triangleIndex = 0; triangleIndex < frame.triangles.size(); ++triangleIndex)
+			{
+				binTriangle(frame, triangleIndex);
+			}
+		}
+
+		void binTriangle(FrameContext<TShader>& frame, const size_t triangleIndex)
+		{
+			const Triangle& triangle    = frame.triangles[triangleIndex];
+			const Rect&     boundingBox = triangle.boundingBox;
+			const size_t    minTileX    = boundingBox.getMinX() / m_tileWidth;
+			const size_t    minTileY    = boundingBox.getMinY() / m_tileHeight;
+			const size_t    maxTileX    = std::min(boundingBox.getMaxX() / m_tileWidth,  m_numTilesX - 1);
+			const size_t    maxTileY    = std::min(boundingBox.getMaxY() / m_tileHeight, m_numTilesY - 1);
+
+			for (size_t tileY = minTileY; tileY <= maxTileY; ++tileY)
+			{
+				for (size_t tileX = minTileX; tileX <= maxTileX; ++tileX)
+				{
+					Tile&      tile    = frame.tiles[tileY * m_numTilesX + tileX];
+					const Rect overlap = boundingBox.intersection(tile.getBounds());
+
+					tile.addTriangleIndex(triangleIndex, (overlap.getMaxX() - overlap.getMinX() + 1) * (overlap.getMaxY() - overlap.getMinY() + 1), triangle.small);
+				}
 			}
 		}
 
-	private:
 		void initThreads(const size_t numThreads)
 		{
 			m_threads.clear();
 
 			for (size_t i = 0; i < numThreads; ++i)
 			{
-				m_threads.emplace_back(new RenderThread<TShader>(m_tiles, m_triangles, m_shaders, m_rasterizationParams));
+#ifdef TR_SIMD
+				if (m_instructionSet == InstructionSet::AVX2)
+				{
+					m_threads.emplace_back(new RenderThread<TShader, InstructionSet::AVX2>(i));
+
+					continue;
+				}
+#endif
+				m_threads.emplace_back(new RenderThread<TShader, InstructionSet::SSE41>(i));
 			}
 		}
 
 	private:
-		size_t                                              m_viewportWidth;
-		size_t                                              m_viewportHeight;
-		std::vector<std::unique_ptr<RenderThread<TShader>>> m_threads;
-		std::vector<Tile>                                   m_tiles;
-		std::vector<TShader>                                m_shaders;
-		std::vector<Triangle>                               m_triangles;
-		std::vector<RasterizationParams>                    m_rasterizationParams;
+		static constexpr size_t                                 s_numFrames         = 2;
+		static constexpr size_t                                 s_smallTriangleSize = 8;
+
+		size_t                                                  m_viewportWidth;
+		size_t                                                  m_viewportHeight;
+		size_t                                                  m_tileWidth;
+		size_t                                                  m_tileHeight;
+		size_t                                                  m_numTilesX;
+		size_t                                                  m_numTilesY;
+		std::array<FrameContext<TShader>, s_numFrames>          m_frames;
+		size_t                                                  m_currentFrameIndex;
+		std::vector<std::unique_ptr<RenderThreadBase<TShader>>> m_threads;
+		TileScheduler                                           m_tileScheduler;
+		bool                                                    m_adaptiveTileSize;
+		bool                                                    m_tileLocalBuffers;
+		bool                                                    m_depthBufferWriteBack;
+		bool                                                    m_depthPrepass;
+		bool                                                    m_visibilityBuffer;
+		TileSizeSelector                                        m_tileSizeSelector;
+		size_t                                                  m_nextTileWidth;
+		size_t                                                  m_nextTileHeight;
+		uint64_t                                                m_lastJobNumber;
+		size_t                                                  m_numDrawingThreads;
+		size_t                                                  m_numDrawnQueries;
+		InstructionSet                                          m_instructionSet;
+
+		// Declared last so it's destroyed first, which waits for a frame that's still in flight
+		WorkerPool                                              m_workerPool;
 	};
 }
\ No newline at end of file
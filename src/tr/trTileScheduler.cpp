@@ -0,0 +1,110 @@
+#include "trTileScheduler.hpp"
+#include <algorithm>
+
+tr::TileScheduler::TileScheduler() :
+	m_numDeques(0)
+{
+}
+
+void tr::TileScheduler::schedule(const std::vector<Tile>& tiles, const size_t numThreads)
+{
+	if (numThreads != m_numDeques)
+	{
+		m_deques.reset(new Deque[numThreads]);
+		m_numDeques = numThreads;
+	}
+
+	m_sortedTileIndices.resize(tiles.size());
+
+	for (size_t tileIndex = 0; tileIndex < tiles.size(); ++tileIndex)
+	{
+		m_sortedTileIndices[tileIndex] = tileIndex;
+	}
+
+	std::stable_sort(m_sortedTileIndices.begin(), m_sortedTileIndices.end(), [&](const size_t lhs, const size_t rhs) { return tiles[lhs].getCost() > tiles[rhs].getCost(); });
+
+	// Deal the tiles out like cards, so every thread starts on one of the most expensive tiles and works its way
+	// down to the cheap ones
+	m_tileOrder.resize(tiles.size());
+
+	for (size_t threadIndex = 0, orderIndex = 0; threadIndex < numThreads; ++threadIndex)
+	{
+		const size_t begin = orderIndex;
+
+		for (size_t sortedIndex = threadIndex; sortedIndex < m_sortedTileIndices.size(); sortedIndex += numThreads, ++orderIndex)
+		{
+			m_tileOrder[orderIndex] = m_sortedTileIndices[sortedIndex];
+		}
+
+		m_deques[threadIndex].range.store(packRange(uint32_t(begin), uint32_t(orderIndex)), std::memory_order_relaxed);
+	}
+}
+
+bool tr::TileScheduler::getNextTile(const size_t threadIndex, size_t& tileIndex)
+{
+	if (popFront(threadIndex, tileIndex))
+	{
+		return true;
+	}
+
+	for (size_t offset = 1; offset < m_numDeques; ++offset)
+	{
+		if (popBack((threadIndex + offset) % m_numDeques, tileIndex))
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool tr::TileScheduler::popFront(const size_t threadIndex, size_t& tileIndex)
+{
+	std::atomic<uint64_t>& range    = m_deques[threadIndex].range;
+	uint64_t               expected = range.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		const uint32_t begin = uint32_t(expected);
+		const uint32_t end   = uint32_t(expected >> 32);
+
+		if (begin >= end)
+		{
+			return false;
+		}
+
+		if (range.compare_exchange_weak(expected, packRange(begin + 1, end), std::memory_order_relaxed))
+		{
+			tileIndex = m_tileOrder[begin];
+			return true;
+		}
+	}
+}
+
+bool tr::TileScheduler::popBack(const size_t threadIndex, size_t& tileIndex)
+{
+	std::atomic<uint64_t>& range    = m_deques[threadIndex].range;
+	uint64_t               expected = range.load(std::memory_order_relaxed);
+
+	for (;;)
+	{
+		const uint32_t begin = uint32_t(expected);
+		const uint32_t end   = uint32_t(expected >> 32);
+
+		if (begin >= end)
+		{
+			return false;
+		}
+
+		if (range.compare_exchange_weak(expected, packRange(begin, end - 1), std::memory_order_relaxed))
+		{
+			tileIndex = m_tileOrder[end - 1];
+			return true;
+		}
+	}
+}
+
+uint64_t tr::TileScheduler::packRange(const uint32_t begin, const uint32_t end)
+{
+	return uint64_t(begin) | (uint64_t(end) << 32);
+}
\ No newline at end of file
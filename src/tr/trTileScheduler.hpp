@@ -0,0 +1,38 @@
+#pragma once
+
+#include "trTile.hpp"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace tr
+{
+	class TileScheduler
+	{
+	public:
+		                              TileScheduler();
+
+		void                          schedule(const std::vector<Tile>& tiles, const size_t numThreads);
+		bool                          getNextTile(const size_t threadIndex, size_t& tileIndex);
+
+	private:
+		bool                          popFront(const size_t threadIndex, size_t& tileIndex);
+		bool                          popBack(const size_t threadIndex, size_t& tileIndex);
+
+		static uint64_t               packRange(const uint32_t begin, const uint32_t end);
+
+	private:
+		// Each thread owns a range of m_tileOrder. The owner takes tiles from the front and thieves take them from the
+		// back, so both ends live in one word that can be updated with a single compare-and-swap.
+		struct alignas(64) Deque
+		{
+			std::atomic<uint64_t>     range;
+		};
+
+		std::vector<size_t>           m_sortedTileIndices;
+		std::vector<size_t>           m_tileOrder;
+		std::unique_ptr<Deque[]>      m_deques;
+		size_t                        m_numDeques;
+	};
+}
\ No newline at end of file
@@ -0,0 +1,103 @@
+#include "trTileSizeSelector.hpp"
+#include "trTile.hpp"
+#include <algorithm>
+
+tr::TileSizeSelector::TileSizeSelector() :
+	m_numTriangles(0.0f),
+	m_widthSum(0.0f),
+	m_heightSum(0.0f),
+	m_areaSum(0.0f),
+	m_numThreads(1),
+	m_viewportWidth(0),
+	m_viewportHeight(0)
+{
+}
+
+bool tr::TileSizeSelector::select(const std::vector<Triangle>& triangles,
+                                  const size_t                 numThreads,
+                                  const size_t                 viewportWidth,
+                                  const size_t                 viewportHeight,
+                                  size_t&                      tileWidth,
+                                  size_t&                      tileHeight)
+{
+	if (triangles.empty())
+	{
+		return false;
+	}
+
+	m_numTriangles   = float(triangles.size());
+	m_widthSum       = 0.0f;
+	m_heightSum      = 0.0f;
+	m_areaSum        = 0.0f;
+	m_numThreads     = std::max(numThreads, size_t(1));
+	m_viewportWidth  = viewportWidth;
+	m_viewportHeight = viewportHeight;
+
+	for (const Triangle& triangle : triangles)
+	{
+		const Rect& boundingBox = triangle.boundingBox;
+		const float width       = float(std::min(boundingBox.getMaxX(), viewportWidth  - 1) - boundingBox.getMinX() + 1);
+		const float height      = float(std::min(boundingBox.getMaxY(), viewportHeight - 1) - boundingBox.getMinY() + 1);
+
+		m_widthSum  += width;
+		m_heightSum += height;
+		m_areaSum   += width * height;
+	}
+
+	const float currentCost = estimateCost(tileWidth, tileHeight);
+	float       bestCost    = currentCost;
+	size_t      bestWidth   = tileWidth;
+	size_t      bestHeight  = tileHeight;
+
+	// Powers of two keep the candidates few and the widths divisible by 4. Tiles much larger than the viewport
+	// are pointless, so stop at the first size that covers it.
+	for (size_t width = s_minTileSize; width <= s_maxTileSize; width *= 2)
+	{
+		for (size_t height = s_minTileSize; height <= s_maxTileSize; height *= 2)
+		{
+			const float cost = estimateCost(width, height);
+
+			if (cost < bestCost)
+			{
+				bestCost   = cost;
+				bestWidth  = width;
+				bestHeight = height;
+			}
+
+			if (height >= viewportHeight)
+			{
+				break;
+			}
+		}
+
+		if (width >= viewportWidth)
+		{
+			break;
+		}
+	}
+
+	if (bestCost > currentCost * s_retileThreshold)
+	{
+		return false;
+	}
+
+	tileWidth  = bestWidth;
+	tileHeight = bestHeight;
+
+	return true;
+}
+
+float tr::TileSizeSelector::estimateCost(const size_t tileWidth, const size_t tileHeight) const
+{
+	const float width          = float(tileWidth);
+	const float height         = float(tileHeight);
+	const float numTiles       = float(((m_viewportWidth + tileWidth - 1) / tileWidth) * ((m_viewportHeight + tileHeight - 1) / tileHeight));
+
+	// Expected number of tiles a bounding box overlaps, summed over all triangles
+	const float numReferences  = m_numTriangles + m_widthSum / width + m_heightSum / height + m_areaSum / (width * height);
+	const float pixelCost      = tileWidth * tileHeight * s_bytesPerPixel > s_cacheSize ? s_cacheMissPenalty : 1.0f;
+	const float work           = numReferences * float(Tile::s_triangleCost) + m_areaSum * pixelCost;
+
+	// The threads share the work evenly at best, and the last tile to be picked up can leave the others idle
+	return work / std::min(float(m_numThreads), numTiles) + work / numTiles;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "trTriangle.hpp"
+#include <vector>
+
+namespace tr
+{
+	// Picks tile dimensions for the next frame from the triangles of the last one, using a rough cost model of
+	// binning, load balancing and how much of a tile's color and depth fits in the cache
+	class TileSizeSelector
+	{
+	public:
+		                        TileSizeSelector();
+
+		bool                    select(const std::vector<Triangle>& triangles,
+		                               const size_t                 numThreads,
+		                               const size_t                 viewportWidth,
+		                               const size_t                 viewportHeight,
+		                               size_t&                      tileWidth,
+		                               size_t&                      tileHeight);
+
+	private:
+		float                   estimateCost(const size_t tileWidth, const size_t tileHeight) const;
+
+	private:
+		// Bytes of color and depth per pixel, and how many of them a core can keep in its cache
+		static constexpr size_t s_bytesPerPixel    = 8;
+		static constexpr size_t s_cacheSize        = 256 * 1024;
+		static constexpr float  s_cacheMissPenalty = 1.5f;
+
+		// Only re-tile when the new size is expected to be this much cheaper, so the size doesn't flip every frame
+		static constexpr float  s_retileThreshold  = 0.9f;
+
+		static constexpr size_t s_minTileSize      = 16;
+		static constexpr size_t s_maxTileSize      = 256;
+
+		float                   m_numTriangles;
+		float                   m_widthSum;
+		float                   m_heightSum;
+		float                   m_areaSum;
+		size_t                  m_numThreads;
+		size_t                  m_viewportWidth;
+		size_t                  m_viewportHeight;
+	};
+}
@@ -1,9 +1,23 @@
 #include "trTriangle.hpp"
+#include <algorithm>
+#include <cmath>
 
-tr::Triangle::Triangle(std::array<TransformedVertex, 3>&& vertices, const size_t shaderIndex, const size_t rasterizationParamsIndex) :
-	vertices(std::move(vertices)),
+tr::Triangle::Triangle(const std::array<TransformedVertex, 3>& vertices, const std::array<EdgeFunction, 3>& edges, const size_t shaderIndex, const size_t rasterizationParamsIndex) :
 	boundingBox(vertices),
+	attributePlanes(vertices),
+	edges(edges),
 	shaderIndex(shaderIndex),
-	rasterizationParamsIndex(rasterizationParamsIndex)
+	rasterizationParamsIndex(rasterizationParamsIndex),
+	minDepth(getMinDepth(vertices)),
+	small(false)
 {
+}
+
+float tr::Triangle::getMinDepth(const std::array<TransformedVertex, 3>& vertices)
+{
+	const float depth0 = vertices[0].projectedPosition.z;
+	const float depth1 = vertices[1].projectedPosition.z;
+	const float depth2 = vertices[2].projectedPosition.z;
+
+	return std::min({ depth0, depth1, depth2 }) - 1.0e-5f * std::max({ std::abs(depth0), std::abs(depth1), std::abs(depth2) });
 }
\ No newline at end of file
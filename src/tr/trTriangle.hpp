@@ -1,20 +1,35 @@
 #pragma once
 
+#include "trAttributePlanes.hpp"
+#include "trEdgeFunction.hpp"
 #include "trQuadFloat.hpp"
 #include "trQuadTransformedVertex.hpp"
 #include "trRect.hpp"
+#include <limits>
 
 namespace tr
 {
 	struct Triangle
 	{
 	public:
-		                                Triangle(std::array<TransformedVertex,3>&& vertices, const size_t shaderIndex, const size_t rasterizationParamsIndex);
+		// Shader index of triangles that only write depth
+		static constexpr size_t         s_noShader = std::numeric_limits<size_t>::max();
 
 	public:
-		std::array<TransformedVertex,3> vertices;
+		                                Triangle(const std::array<TransformedVertex,3>& vertices, const std::array<EdgeFunction,3>& edges, const size_t shaderIndex, const size_t rasterizationParamsIndex);
+
+	public:
+		// Only what's rasterized is kept, not the vertices, so that queueing has less to copy
 		Rect                            boundingBox;
+		AttributePlanes                 attributePlanes;
+		std::array<EdgeFunction,3>      edges;
 		size_t                          shaderIndex;
 		size_t                          rasterizationParamsIndex;
+		float                           minDepth;
+		bool                            small;
+
+	private:
+		// Nearest depth of the triangle, pulled a little closer because interpolated depths can round past it
+		static float                    getMinDepth(const std::array<TransformedVertex,3>& vertices);
 	};
 }
\ No newline at end of file
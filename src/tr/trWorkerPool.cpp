@@ -0,0 +1,213 @@
+#include "trWorkerPool.hpp"
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__i386__) || defined(__x86_64__)
+#include <immintrin.h>
+#define TR_HAS_PAUSE
+#endif
+
+tr::WorkerPool::WorkerPool() :
+	m_job(),
+	m_numActiveWorkers(0),
+	m_firstThreadIndex(0),
+	m_numJobs(0),
+	m_generation(0),
+	m_numPendingWorkers(0),
+	m_numParkedWorkers(0),
+	m_numParkedCallers(0),
+	m_quit(false)
+{
+}
+
+tr::WorkerPool::~WorkerPool()
+{
+	stopWorkers();
+}
+
+void tr::WorkerPool::run(const size_t numThreads, const Job& job)
+{
+	wait();
+
+	// The calling thread takes part as thread 0, so only the others need a worker
+	const size_t numWorkers = numThreads > 0 ? numThreads - 1 : 0;
+
+	if (numWorkers > 0)
+	{
+		dispatch(numWorkers, 1, job);
+	}
+
+	m_numJobs.fetch_add(1, std::memory_order_release);
+
+	job(0);
+
+	wait();
+}
+
+uint64_t tr::WorkerPool::start(const size_t numThreads, const Job& job)
+{
+	wait();
+
+	dispatch(std::max(numThreads, size_t(1)), 0, job);
+
+	// Counted after dispatching, so that whoever sees the new count also sees the pending workers of the new job
+	return m_numJobs.fetch_add(1, std::memory_order_release) + 1;
+}
+
+bool tr::WorkerPool::isComplete(const uint64_t jobNumber) const
+{
+	// Only one job is ever in flight, so every job before the latest one has finished. The count is read first: if it
+	// still ends at this job, the pending workers read after it belong to this job or to a later one, so a finished
+	// job can briefly read as in flight while the next is dispatched, but never the other way around.
+	if (jobNumber < m_numJobs.load(std::memory_order_acquire))
+	{
+		return true;
+	}
+
+	return m_numPendingWorkers.load(std::memory_order_acquire) == 0;
+}
+
+void tr::WorkerPool::wait()
+{
+	for (size_t i = 0; i < s_spinCount; ++i)
+	{
+		if (m_numPendingWorkers.load(std::memory_order_acquire) == 0)
+		{
+			return;
+		}
+
+		pause();
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	// Counted rather than flagged, since a frame handle and a query can both be waiting
+	m_numParkedCallers.fetch_add(1);
+	m_callerConditionVariable.wait(lock, [&]{ return m_numPendingWorkers.load() == 0; });
+	m_numParkedCallers.fetch_sub(1);
+}
+
+void tr::WorkerPool::dispatch(const size_t numWorkers, const size_t firstThreadIndex, const Job& job)
+{
+	// Synchronous runs need one worker fewer than asynchronous ones, so keep the spare worker around rather than
+	// restarting threads when an application alternates between them
+	if (numWorkers > m_workers.size() || numWorkers + 1 < m_workers.size())
+	{
+		resize(numWorkers);
+	}
+
+	m_job              = job;
+	m_numActiveWorkers = numWorkers;
+	m_firstThreadIndex = firstThreadIndex;
+
+	// A spare worker still has to check in, otherwise it could be reading the job while the next one is dispatched
+	m_numPendingWorkers.store(m_workers.size());
+
+	// Sequentially consistent, because it's paired with the parked worker count below
+	m_generation.fetch_add(1);
+
+	if (m_numParkedWorkers.load() > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+		}
+
+		m_workerConditionVariable.notify_all();
+	}
+}
+
+void tr::WorkerPool::resize(const size_t numWorkers)
+{
+	stopWorkers();
+
+	m_quit = false;
+
+	for (size_t workerIndex = 0; workerIndex < numWorkers; ++workerIndex)
+	{
+		m_workers.emplace_back(&WorkerPool::workerFunction, this, workerIndex, m_generation.load());
+	}
+}
+
+void tr::WorkerPool::stopWorkers()
+{
+	if (m_workers.empty())
+	{
+		return;
+	}
+
+	wait();
+
+	m_quit = true;
+	m_generation.fetch_add(1);
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+	}
+
+	m_workerConditionVariable.notify_all();
+
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+
+	m_workers.clear();
+}
+
+void tr::WorkerPool::workerFunction(const size_t workerIndex, uint64_t seenGeneration)
+{
+	for (;;)
+	{
+		seenGeneration = waitForGeneration(seenGeneration);
+
+		if (m_quit)
+		{
+			return;
+		}
+
+		if (workerIndex < m_numActiveWorkers)
+		{
+			m_job(m_firstThreadIndex + workerIndex);
+		}
+
+		if (m_numPendingWorkers.fetch_sub(1) == 1 && m_numParkedCallers.load() > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+			}
+
+			m_callerConditionVariable.notify_all();
+		}
+	}
+}
+
+uint64_t tr::WorkerPool::waitForGeneration(const uint64_t seenGeneration)
+{
+	for (size_t i = 0; i < s_spinCount; ++i)
+	{
+		const uint64_t generation = m_generation.load(std::memory_order_acquire);
+
+		if (generation != seenGeneration)
+		{
+			return generation;
+		}
+
+		pause();
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	m_numParkedWorkers.fetch_add(1);
+	m_workerConditionVariable.wait(lock, [&]{ return m_generation.load() != seenGeneration; });
+	m_numParkedWorkers.fetch_sub(1);
+
+	return m_generation.load();
+}
+
+void tr::WorkerPool::pause()
+{
+#ifdef TR_HAS_PAUSE
+	_mm_pause();
+#else
+	std::this_thread::yield();
+#endif
+}
\ No newline at end of file
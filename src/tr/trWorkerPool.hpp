@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace tr
+{
+	class WorkerPool
+	{
+	public:
+		typedef std::function<void(const size_t threadIndex)> Job;
+
+		                         WorkerPool();
+		                         WorkerPool(const WorkerPool&) = delete;
+		                         ~WorkerPool();
+
+		WorkerPool&              operator=(const WorkerPool&) = delete;
+
+		void                     run(const size_t numThreads, const Job& job);
+		uint64_t                 start(const size_t numThreads, const Job& job);
+		bool                     isComplete(const uint64_t jobNumber) const;
+		void                     wait();
+
+	private:
+		void                     dispatch(const size_t numWorkers, const size_t firstThreadIndex, const Job& job);
+		void                     resize(const size_t numWorkers);
+		void                     stopWorkers();
+		void                     workerFunction(const size_t workerIndex, uint64_t seenGeneration);
+		uint64_t                 waitForGeneration(const uint64_t seenGeneration);
+
+		static void              pause();
+
+	private:
+		// Roughly how long to busy-wait before falling back to the condition variables. Frames at high frame rates
+		// follow each other closely enough that the workers rarely need to be woken by the OS.
+		static constexpr size_t  s_spinCount = 4096;
+
+		std::vector<std::thread> m_workers;
+		Job                      m_job;
+		size_t                   m_numActiveWorkers;
+		size_t                   m_firstThreadIndex;
+		std::atomic<uint64_t>    m_numJobs;
+		std::atomic<uint64_t>    m_generation;
+		std::atomic<size_t>      m_numPendingWorkers;
+		std::atomic<size_t>      m_numParkedWorkers;
+		std::atomic<size_t>      m_numParkedCallers;
+		std::atomic<bool>        m_quit;
+		std::mutex               m_mutex;
+		std::condition_variable  m_workerConditionVariable;
+		std::condition_variable  m_callerConditionVariable;
+	};
+}
\ No newline at end of file